@@ -0,0 +1,194 @@
+/**
+* \file AffineTransform.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for 3x4 affine transformation matrices
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_AFFINE_TRANSFORM_H
+#define RAYCHEL_AFFINE_TRANSFORM_H
+
+#include "SDFBounds.h"
+#include "Types.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace Raychel {
+
+    //3x4 matrix that maps p to linear * p + translation. The linear part is stored row by row
+    struct AffineTransform
+    {
+        vec3 row_x{1, 0, 0};
+        vec3 row_y{0, 1, 0};
+        vec3 row_z{0, 0, 1};
+        vec3 translation{};
+    };
+
+    [[nodiscard]] inline vec3 apply_linear(const AffineTransform& transform, const vec3& v) noexcept
+    {
+        return vec3{dot(transform.row_x, v), dot(transform.row_y, v), dot(transform.row_z, v)};
+    }
+
+    [[nodiscard]] inline vec3 apply(const AffineTransform& transform, const vec3& p) noexcept
+    {
+        return apply_linear(transform, p) + transform.translation;
+    }
+
+    [[nodiscard]] inline AffineTransform from_translation(const vec3& translation) noexcept
+    {
+        return AffineTransform{.translation = translation};
+    }
+
+    //Transform that maps p to p * rotation
+    [[nodiscard]] inline AffineTransform from_rotation(const Quaternion& rotation) noexcept
+    {
+        const auto x = vec3{1, 0, 0} * rotation;
+        const auto y = vec3{0, 1, 0} * rotation;
+        const auto z = vec3{0, 0, 1} * rotation;
+
+        //The rotated basis vectors are the columns of the matrix
+        return AffineTransform{
+            vec3{x.x(), y.x(), z.x()},
+            vec3{x.y(), y.y(), z.y()},
+            vec3{x.z(), y.z(), z.z()},
+        };
+    }
+
+    [[nodiscard]] inline AffineTransform from_scale(double factor) noexcept
+    {
+        return AffineTransform{vec3{factor, 0, 0}, vec3{0, factor, 0}, vec3{0, 0, factor}};
+    }
+
+    //Transform that applies inner first, then outer
+    [[nodiscard]] inline AffineTransform compose(const AffineTransform& outer, const AffineTransform& inner) noexcept
+    {
+        const auto row = [&inner](const vec3& outer_row) {
+            return inner.row_x * outer_row.x() + inner.row_y * outer_row.y() + inner.row_z * outer_row.z();
+        };
+        return AffineTransform{row(outer.row_x), row(outer.row_y), row(outer.row_z), apply(outer, inner.translation)};
+    }
+
+    [[nodiscard]] inline double determinant(const AffineTransform& transform) noexcept
+    {
+        return dot(transform.row_x, cross(transform.row_y, transform.row_z));
+    }
+
+    //Inverse of the transform. The transform must not be singular
+    [[nodiscard]] inline AffineTransform inverse(const AffineTransform& transform) noexcept
+    {
+        const auto det = determinant(transform);
+        RAYCHEL_ASSERT(det != 0.0);
+
+        //The columns of the inverse are the cross products of the rows
+        const auto x = cross(transform.row_y, transform.row_z) / det;
+        const auto y = cross(transform.row_z, transform.row_x) / det;
+        const auto z = cross(transform.row_x, transform.row_y) / det;
+
+        AffineTransform result{
+            vec3{x.x(), y.x(), z.x()},
+            vec3{x.y(), y.y(), z.y()},
+            vec3{x.z(), y.z(), z.z()},
+        };
+        result.translation = -apply_linear(result, transform.translation);
+        return result;
+    }
+
+    /**
+    * \brief Smallest factor by which the transform stretches a vector
+    *
+    * Distances measured before the transform have to be multiplied by this to stay conservative. Exact for rotations,
+    * translations and (non-)uniform axis scales.
+    */
+    [[nodiscard]] inline double minimum_scale(const AffineTransform& transform) noexcept
+    {
+        const auto column_length = [&transform](const vec3& unit) { return mag(apply_linear(transform, unit)); };
+        return std::min({column_length(vec3{1, 0, 0}), column_length(vec3{0, 1, 0}), column_length(vec3{0, 0, 1})});
+    }
+
+    //Largest factor by which the transform stretches a vector, which is the largest singular value of the linear part
+    [[nodiscard]] inline double maximum_scale(const AffineTransform& transform) noexcept
+    {
+        //The singular values are the square roots of the eigenvalues of the symmetric matrix M * M^T
+        const auto& [r0, r1, r2, _] = transform;
+        const auto a00 = dot(r0, r0);
+        const auto a11 = dot(r1, r1);
+        const auto a22 = dot(r2, r2);
+        const auto a01 = dot(r0, r1);
+        const auto a02 = dot(r0, r2);
+        const auto a12 = dot(r1, r2);
+
+        //Closed form for the eigenvalues of a symmetric 3x3 matrix, see https://en.wikipedia.org/wiki/Eigenvalue_algorithm#3%C3%973_matrices
+        const auto off_diagonal = sq(a01) + sq(a02) + sq(a12);
+        const auto q = (a00 + a11 + a22) / 3.0;
+        const auto p = std::sqrt((sq(a00 - q) + sq(a11 - q) + sq(a22 - q) + 2.0 * off_diagonal) / 6.0);
+        if (p == 0.0) {
+            return std::sqrt(q);
+        }
+
+        const auto b00 = (a00 - q) / p;
+        const auto b11 = (a11 - q) / p;
+        const auto b22 = (a22 - q) / p;
+        const auto b01 = a01 / p;
+        const auto b02 = a02 / p;
+        const auto b12 = a12 / p;
+        const auto half_det =
+            (b00 * (b11 * b22 - b12 * b12) - b01 * (b01 * b22 - b12 * b02) + b02 * (b01 * b12 - b11 * b02)) / 2.0;
+
+        const auto phi = std::acos(std::clamp(half_det, -1.0, 1.0)) / 3.0;
+        return std::sqrt(q + 2.0 * p * std::cos(phi));
+    }
+
+    //Bounds of the transformed box. This is conservative, the result may be larger than the tightest possible box
+    [[nodiscard]] inline AABB transform_bounds(const AABB& box, const AffineTransform& transform) noexcept
+    {
+        if (!box.is_finite() || box.is_empty()) {
+            return box;
+        }
+
+        auto result = AABB::empty();
+        for (std::size_t i{}; i != 8U; ++i) {
+            const vec3 corner{
+                (i & 1U) != 0U ? box.upper.x() : box.lower.x(),
+                (i & 2U) != 0U ? box.upper.y() : box.lower.y(),
+                (i & 4U) != 0U ? box.upper.z() : box.lower.z()};
+            const auto transformed = apply(transform, corner);
+            result = merge(result, AABB{transformed, transformed});
+        }
+        return result;
+    }
+
+    inline std::ostream& operator<<(std::ostream& os, const AffineTransform& transform)
+    {
+        return os << transform.row_x << ' ' << transform.row_y << ' ' << transform.row_z << ' ' << transform.translation;
+    }
+
+    inline std::istream& operator>>(std::istream& is, AffineTransform& transform)
+    {
+        return is >> transform.row_x >> transform.row_y >> transform.row_z >> transform.translation;
+    }
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_AFFINE_TRANSFORM_H
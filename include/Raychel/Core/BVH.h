@@ -0,0 +1,182 @@
+/**
+* \file BVH.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for BoundingVolumeHierarchy class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_BVH_H
+#define RAYCHEL_BVH_H
+
+#include "SDFBounds.h"
+#include "Types.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Raychel {
+
+    namespace details {
+
+        /**
+        * \brief Bounding volume hierarchy over a list of AABBs, used to find the closest of many objects and to clip rays
+        *
+        * The hierarchy only stores the bounds and the indices of its leaves. The caller supplies the actual distance function
+        * when querying, so the same hierarchy can be used for instances, union members or anything else with bounds.
+        */
+        class BoundingVolumeHierarchy
+        {
+        public:
+            BoundingVolumeHierarchy() = default;
+
+            explicit BoundingVolumeHierarchy(const std::vector<AABB>& leaf_bounds) noexcept;
+
+            [[nodiscard]] bool empty() const noexcept
+            {
+                return nodes_.empty();
+            }
+
+            [[nodiscard]] AABB bounds() const noexcept
+            {
+                if (nodes_.empty()) {
+                    return AABB::empty();
+                }
+                return nodes_.front().bounds;
+            }
+
+            /**
+            * \brief Find the leaf with the smallest distance to p
+            *
+            * Subtrees and leaves whose bounds are further away than the closest distance found so far are skipped. F must be
+            * callable with a leaf index and return the signed distance of that leaf. Leaves are only considered if they are
+            * closer than upper_bound, which lets the caller seed the search with a distance it already knows.
+            *
+            * \return distance and index of the closest leaf, or {upper_bound, no leaf} if no leaf is closer than upper_bound
+            */
+            template <typename F>
+            [[nodiscard]] std::pair<double, std::size_t>
+            closest(const vec3& p, F&& distance_to_leaf, double upper_bound = 1e9) const noexcept
+            {
+                struct StackEntry
+                {
+                    std::uint32_t node_index;
+                    double lower_bound;
+                };
+
+                double closest_distance{upper_bound};
+                auto closest_leaf = std::numeric_limits<std::size_t>::max();
+
+                if (nodes_.empty()) {
+                    return {closest_distance, closest_leaf};
+                }
+
+                std::array<StackEntry, max_depth> stack{};
+                std::size_t stack_size{};
+                stack[stack_size++] = {0U, distance_to_bounds(nodes_.front().bounds, p)};
+
+                while (stack_size != 0U) {
+                    const auto [node_index, lower_bound] = stack[--stack_size];
+                    if (_can_skip(lower_bound, closest_distance)) {
+                        continue;
+                    }
+
+                    const auto& node = nodes_[node_index];
+                    if (node.is_leaf()) {
+                        for (auto i = node.first; i != node.first + node.count; ++i) {
+                            if (_can_skip(distance_to_bounds(ordered_leaf_bounds_[i], p), closest_distance)) {
+                                continue;
+                            }
+                            const auto leaf = leaf_order_[i];
+                            const auto distance = distance_to_leaf(leaf);
+                            if (distance < closest_distance) {
+                                closest_distance = distance;
+                                closest_leaf = leaf;
+                            }
+                        }
+                        continue;
+                    }
+
+                    //Push the further child first so the closer one is visited first
+                    const auto left_bound = distance_to_bounds(nodes_[node.first].bounds, p);
+                    const auto right_bound = distance_to_bounds(nodes_[node.first + 1U].bounds, p);
+                    const StackEntry left{node.first, left_bound};
+                    const StackEntry right{node.first + 1U, right_bound};
+                    if (left_bound < right_bound) {
+                        stack[stack_size++] = right;
+                        stack[stack_size++] = left;
+                    } else {
+                        stack[stack_size++] = left;
+                        stack[stack_size++] = right;
+                    }
+                }
+
+                return {closest_distance, closest_leaf};
+            }
+
+            /**
+            * \brief Smallest interval that covers the intersections of the ray with the bounds of every leaf
+            *
+            * Leaves that lie entirely behind the origin are ignored. Subtrees are skipped if the ray misses their bounds or if
+            * their interval already lies inside the interval found so far, so most rays only visit a few nodes.
+            */
+            [[nodiscard]] RayInterval clip_ray(const vec3& origin, const vec3& direction) const noexcept;
+
+        private:
+            //The tree is split at the median, so its depth is logarithmic in the leaf count. Two stack slots per level suffice
+            static constexpr std::size_t max_depth{128U};
+
+            struct Node
+            {
+                [[nodiscard]] bool is_leaf() const noexcept
+                {
+                    return count != 0U;
+                }
+
+                AABB bounds{};
+                //Leaf: index of the first leaf in leaf_order_. Inner node: index of the left child, the right child follows it
+                std::uint32_t first{};
+                std::uint32_t count{};
+            };
+
+            //Bounds that contain p say nothing about how deep inside an object p is, so they are never skipped
+            [[nodiscard]] static bool _can_skip(double distance_to_bounds, double closest_distance) noexcept
+            {
+                return distance_to_bounds > 0.0 && distance_to_bounds >= closest_distance;
+            }
+
+            void _build(std::uint32_t node_index, std::uint32_t first, std::uint32_t count, const std::vector<AABB>& leaf_bounds);
+
+            std::vector<Node> nodes_{};
+            std::vector<std::uint32_t> leaf_order_{};
+            //Bounds of the leaves in the order of leaf_order_
+            std::vector<AABB> ordered_leaf_bounds_{};
+        };
+
+    } // namespace details
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_BVH_H
@@ -0,0 +1,84 @@
+/**
+* \file BulkQuery.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for bulk distance field queries
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_BULK_QUERY_H
+#define RAYCHEL_BULK_QUERY_H
+
+#include "FrozenScene.h"
+#include "Types.h"
+
+#include <span>
+
+namespace Raychel {
+
+    //Query points stored as one array per coordinate. All three arrays must have the same size
+    struct PointsSoA
+    {
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return x.size();
+        }
+
+        std::span<const double> x;
+        std::span<const double> y;
+        std::span<const double> z;
+    };
+
+    /**
+    * \brief Output arrays of a bulk query. Each non-empty span must be at least as large as the number of query points
+    *
+    * distances:   signed distance to the closest surface (the surface with the smallest absolute distance). Distances are
+    *              divided by the Lipschitz constant of their surface, so they never overestimate the true distance
+    * hit_indices: index of that surface in the scene, or no_hit if the scene is empty. May be empty
+    * gradients:   normalized gradient of the closest surface at the query point. May be empty, in which case no gradients
+    *              are computed
+    */
+    struct BulkQueryOutput
+    {
+        std::span<double> distances;
+        std::span<std::size_t> hit_indices{};
+        std::span<vec3> gradients{};
+    };
+
+    struct BulkQueryOptions
+    {
+        //Offset used for gradient calculation of surfaces without a custom normal
+        double gradient_offset{1e-6};
+
+        //Whether the query may be split across multiple threads
+        bool parallel{true};
+    };
+
+    void evaluate_distance_field(
+        const FrozenScene& scene, std::span<const vec3> points, BulkQueryOutput output, BulkQueryOptions options = {}) noexcept;
+
+    void evaluate_distance_field(
+        const FrozenScene& scene, PointsSoA points, BulkQueryOutput output, BulkQueryOptions options = {}) noexcept;
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_BULK_QUERY_H
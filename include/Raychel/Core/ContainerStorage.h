@@ -0,0 +1,207 @@
+/**
+* \file ContainerStorage.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for ContainerStorage and ContainerArena classes
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_CONTAINER_STORAGE_H
+#define RAYCHEL_CONTAINER_STORAGE_H
+
+#include "RaychelCore/ClassMacros.h"
+#include "RaychelCore/Raychel_assert.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Raychel::details {
+
+    /**
+    * \brief Monotonic allocator for container implementations
+    *
+    * Memory is handed out from large blocks in allocation order and is only released when the arena is destroyed. Objects
+    * placed in the arena must be destroyed before the arena itself.
+    */
+    class ContainerArena
+    {
+    public:
+        ContainerArena() = default;
+
+        RAYCHEL_MAKE_NONCOPY_NONMOVE(ContainerArena)
+
+        [[nodiscard]] void* allocate(std::size_t size, std::size_t alignment) noexcept;
+
+        [[nodiscard]] std::size_t bytes_used() const noexcept
+        {
+            return bytes_used_;
+        }
+
+        ~ContainerArena() = default;
+
+    private:
+        static constexpr std::size_t block_size{64U * 1024U};
+
+        std::vector<std::unique_ptr<std::byte[]>> blocks_{};
+        std::size_t current_block_size_{};
+        std::size_t current_offset_{};
+        std::size_t bytes_used_{};
+    };
+
+    /**
+    * \brief Owning pointer to a polymorphic container implementation with a small buffer optimization
+    *
+    * Implementations that fit into InlineSize bytes are stored inside the ContainerStorage itself, larger ones on the heap.
+    * move_into() moves the implementation into a ContainerArena.
+    *
+    * Interface must provide
+    *  Interface* move_to(void* storage) noexcept, which move-constructs the implementation at storage
+    *  std::size_t storage_size() const noexcept
+    *  std::size_t storage_alignment() const noexcept
+    */
+    template <typename Interface, std::size_t InlineSize>
+    class ContainerStorage
+    {
+        enum class Location : std::uint8_t {
+            none,
+            inline_buffer,
+            heap,
+            arena,
+        };
+
+    public:
+        template <typename Impl>
+        static constexpr bool fits_inline_v = (sizeof(Impl) <= InlineSize) && (alignof(Impl) <= alignof(std::max_align_t));
+
+        template <typename Impl, typename T>
+        ContainerStorage(std::in_place_type_t<Impl> /*unused*/, T&& object) noexcept(std::is_nothrow_constructible_v<Impl, T&&>)
+        {
+            if constexpr (fits_inline_v<Impl>) {
+                impl_ = new (buffer_.data()) Impl{std::forward<T>(object)};
+                location_ = Location::inline_buffer;
+            } else {
+                impl_ = new Impl{std::forward<T>(object)};
+                location_ = Location::heap;
+            }
+        }
+
+        RAYCHEL_MAKE_NONCOPY(ContainerStorage)
+
+        ContainerStorage(ContainerStorage&& other) noexcept
+        {
+            _take(other);
+        }
+
+        ContainerStorage& operator=(ContainerStorage&& other) noexcept
+        {
+            if (this != &other) {
+                _reset();
+                _take(other);
+            }
+            return *this;
+        }
+
+        [[nodiscard]] Interface* get() const noexcept
+        {
+            return impl_;
+        }
+
+        [[nodiscard]] bool is_inline() const noexcept
+        {
+            return location_ == Location::inline_buffer;
+        }
+
+        [[nodiscard]] bool is_in_arena() const noexcept
+        {
+            return location_ == Location::arena;
+        }
+
+        void move_into(ContainerArena& arena) noexcept
+        {
+            if (impl_ == nullptr) {
+                return;
+            }
+
+            auto* storage = arena.allocate(impl_->storage_size(), impl_->storage_alignment());
+            auto* moved_impl = impl_->move_to(storage);
+
+            _reset();
+            impl_ = moved_impl;
+            location_ = Location::arena;
+        }
+
+        ~ContainerStorage()
+        {
+            _reset();
+        }
+
+    private:
+        void _take(ContainerStorage& other) noexcept
+        {
+            switch (other.location_) {
+                case Location::inline_buffer:
+                    impl_ = other.impl_->move_to(buffer_.data());
+                    location_ = Location::inline_buffer;
+                    other._reset();
+                    break;
+                case Location::heap:
+                case Location::arena:
+                    impl_ = std::exchange(other.impl_, nullptr);
+                    location_ = std::exchange(other.location_, Location::none);
+                    break;
+                case Location::none:
+                    break;
+            }
+        }
+
+        void _reset() noexcept
+        {
+            switch (location_) {
+                case Location::inline_buffer:
+                case Location::arena:
+                    //The memory is owned by someone else, only destroy the object
+                    impl_->~Interface();
+                    break;
+                case Location::heap:
+                    delete impl_;
+                    break;
+                case Location::none:
+                    break;
+            }
+            impl_ = nullptr;
+            location_ = Location::none;
+        }
+
+        alignas(std::max_align_t) std::array<std::byte, InlineSize> buffer_;
+        Interface* impl_{nullptr};
+        Location location_{Location::none};
+    };
+
+} // namespace Raychel::details
+
+#endif //!RAYCHEL_CONTAINER_STORAGE_H
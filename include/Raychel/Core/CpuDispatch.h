@@ -0,0 +1,57 @@
+/**
+* \file CpuDispatch.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for runtime instruction set dispatch of hot kernels
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_CPU_DISPATCH_H
+#define RAYCHEL_CPU_DISPATCH_H
+
+/**
+* \brief Compile a function once per instruction set and select the best version when the library is loaded
+*
+* The version is picked by the dynamic loader through CPUID, so one binary uses AVX-512 where it is available and still runs
+* on older CPUs. Functions called from a marked function are only compiled for the wider instruction sets if they are inlined,
+* so this should be put on the outermost function of a kernel, not on the loop body.
+*
+* Enabled by the RAYCHEL_CPU_DISPATCH CMake option. Only supported by GCC and Clang on x86-64 targets with ifunc support.
+*/
+#if defined(RAYCHEL_CPU_DISPATCH) && defined(__x86_64__) && defined(__has_attribute)
+    #if __has_attribute(target_clones)
+        #define RAYCHEL_DISPATCH_KERNEL __attribute__((target_clones("default", "sse4.2", "avx2", "avx512f")))
+    #endif
+#endif
+
+#ifndef RAYCHEL_DISPATCH_KERNEL
+    #define RAYCHEL_DISPATCH_KERNEL
+#endif
+
+//Helpers of a kernel have to be inlined into it to be compiled for the instruction set of each version
+#if defined(__GNUC__)
+    #define RAYCHEL_KERNEL_INLINE [[gnu::always_inline]] inline
+#else
+    #define RAYCHEL_KERNEL_INLINE inline
+#endif
+
+#endif //!RAYCHEL_CPU_DISPATCH_H
@@ -0,0 +1,94 @@
+/**
+* \file DistanceGrid.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for the scene distance lower bound grid
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_DISTANCE_GRID_H
+#define RAYCHEL_DISTANCE_GRID_H
+
+#include "SDFBounds.h"
+#include "Types.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Raychel {
+
+    struct DistanceGridOptions
+    {
+        //Number of cells along the longest axis of the scene bounds. If 0, no grid is built
+        std::size_t resolution{64};
+    };
+
+    /**
+    * \brief Coarse grid that stores a conservative lower bound of the absolute scene distance
+    *
+    * The grid covers the bounds of all bounded surfaces of the scene. Every cell stores the absolute scene distance at its
+    * center, so the distance at any point p in the cell is at least that value minus the distance between p and the center.
+    * This allows the ray marcher to take large steps through empty space without evaluating the scene.
+    *
+    * The grid is built from a FrozenScene, but does not reference it afterwards. It has to be rebuilt if the scene changes.
+    */
+    class DistanceGrid
+    {
+    public:
+        DistanceGrid() = default;
+
+        DistanceGrid(const FrozenScene& scene, const DistanceGridOptions& options) noexcept;
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return center_distances_.empty();
+        }
+
+        [[nodiscard]] const AABB& bounds() const noexcept
+        {
+            return bounds_;
+        }
+
+        [[nodiscard]] double cell_size() const noexcept
+        {
+            return cell_size_;
+        }
+
+        //Lower bound for the absolute scene distance at p. 0 if nothing is known about p
+        [[nodiscard]] double lower_bound(const vec3& p) const noexcept;
+
+    private:
+        AABB bounds_{AABB::empty()};
+        double cell_size_{};
+        std::array<std::size_t, 3> cell_count_{};
+
+        //If every surface is bounded, the distance to the grid bounds is a lower bound for points outside the grid
+        bool is_scene_bounded_{false};
+
+        //Rounded towards zero, so they are still lower bounds
+        std::vector<float> center_distances_{};
+    };
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_DISTANCE_GRID_H
@@ -0,0 +1,187 @@
+/**
+* \file FrozenScene.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for FrozenScene class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_FROZEN_SCENE_H
+#define RAYCHEL_FROZEN_SCENE_H
+
+#include "BVH.h"
+#include "DistanceGrid.h"
+#include "SDFContainer.h"
+#include "Types.h"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace Raychel {
+
+    namespace details {
+
+        //All Translate<Sphere>s of a scene, stored as structure of arrays
+        template <typename T>
+        struct BasicSphereGroup
+        {
+            [[nodiscard]] std::size_t size() const noexcept
+            {
+                return radius.size();
+            }
+
+            std::vector<T> center_x{}, center_y{}, center_z{};
+            std::vector<T> radius{};
+            std::vector<std::size_t> index_in_scene{};
+        };
+
+        //All Translate<Box>es of a scene, stored as structure of arrays
+        template <typename T>
+        struct BasicBoxGroup
+        {
+            [[nodiscard]] std::size_t size() const noexcept
+            {
+                return size_x.size();
+            }
+
+            std::vector<T> center_x{}, center_y{}, center_z{};
+            std::vector<T> size_x{}, size_y{}, size_z{};
+            std::vector<std::size_t> index_in_scene{};
+        };
+
+        using SphereGroup = BasicSphereGroup<double>;
+        using BoxGroup = BasicBoxGroup<double>;
+
+    } // namespace details
+
+    /**
+    * \brief Read-only snapshot of a list of surfaces that is optimized for distance field evaluation
+    *
+    * Surfaces whose type is known to the FrozenScene (spheres and boxes, optionally translated) are copied into contiguous
+    * arrays and evaluated by a vectorizable kernel. All other surfaces are evaluated through their SDFContainer as usual.
+    * The groups are also kept in single precision, which doubles the vector width of the kernels during mixed precision marching.
+    * The FrozenScene references the original surfaces, so it must not outlive them and has to be rebuilt if they change.
+    */
+    class FrozenScene
+    {
+    public:
+        explicit FrozenScene(const std::vector<SDFContainer>& surfaces) noexcept;
+
+        //Also builds a DistanceGrid over the surfaces, which raymarch() uses to skip empty space
+        FrozenScene(const std::vector<SDFContainer>& surfaces, const DistanceGridOptions& grid_options) noexcept;
+
+        /**
+        * \brief Only consider the surfaces with the given indices
+        *
+        * Hit indices still refer to the full list of surfaces. The indices must be sorted in ascending order.
+        */
+        FrozenScene(const std::vector<SDFContainer>& surfaces, std::span<const std::size_t> subset) noexcept;
+
+        [[nodiscard]] const std::vector<SDFContainer>& surfaces() const noexcept
+        {
+            return *surfaces_;
+        }
+
+        [[nodiscard]] const details::SphereGroup& spheres() const noexcept
+        {
+            return spheres_;
+        }
+
+        [[nodiscard]] const details::BoxGroup& boxes() const noexcept
+        {
+            return boxes_;
+        }
+
+        [[nodiscard]] const details::BasicSphereGroup<float>& spheres_float() const noexcept
+        {
+            return spheres_float_;
+        }
+
+        [[nodiscard]] const details::BasicBoxGroup<float>& boxes_float() const noexcept
+        {
+            return boxes_float_;
+        }
+
+        /**
+        * \brief Largest coordinate magnitude of any grouped surface (center plus extent)
+        *
+        * The rounding error of the single precision kernels grows with the magnitude of their inputs, so this bounds how far
+        * a single precision distance can be off.
+        */
+        [[nodiscard]] double float_group_magnitude() const noexcept
+        {
+            return float_group_magnitude_;
+        }
+
+        //Indices of all surfaces that are not part of any group
+        [[nodiscard]] const std::vector<std::size_t>& remaining_surfaces() const noexcept
+        {
+            return remaining_surfaces_;
+        }
+
+        //Bounds of the surfaces considered by this scene, in the same order as they were added
+        [[nodiscard]] const std::vector<AABB>& surface_bounds() const noexcept
+        {
+            return surface_bounds_;
+        }
+
+        //Bounds of all surfaces. Infinite if any surface is unbounded
+        [[nodiscard]] const AABB& bounds() const noexcept
+        {
+            return bounds_;
+        }
+
+        /**
+        * \brief Range of ray parameters in which the ray can hit any surface
+        *
+        * This is the smallest interval that covers the intersections of the ray with the bounds of every surface. If it is
+        * empty (or lies behind the origin), the ray misses the whole scene. The bounds are searched through a hierarchy, so
+        * the cost grows logarithmically with the number of surfaces the ray does not pass near.
+        */
+        [[nodiscard]] RayInterval clip_ray(const vec3& origin, const vec3& direction) const noexcept;
+
+        //Empty unless the scene was built with DistanceGridOptions
+        [[nodiscard]] const DistanceGrid& distance_grid() const noexcept
+        {
+            return distance_grid_;
+        }
+
+    private:
+        void _add_surface(std::size_t index) noexcept;
+
+        const std::vector<SDFContainer>* surfaces_;
+        details::SphereGroup spheres_{};
+        details::BoxGroup boxes_{};
+        details::BasicSphereGroup<float> spheres_float_{};
+        details::BasicBoxGroup<float> boxes_float_{};
+        double float_group_magnitude_{};
+        std::vector<std::size_t> remaining_surfaces_{};
+        std::vector<AABB> surface_bounds_{};
+        AABB bounds_{AABB::empty()};
+        details::BoundingVolumeHierarchy bounds_hierarchy_{};
+        DistanceGrid distance_grid_{};
+    };
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_FROZEN_SCENE_H
@@ -51,14 +51,32 @@ namespace Raychel {
         std::size_t max_ray_steps{1'000};
         double max_ray_depth{100};
         double surface_epsilon{1e-3};
+
+        //Only used for FrozenScenes: march in single precision while the ray is far away from all surfaces. Hits are always found in double precision
+        bool mixed_precision{false};
     };
 
+    /**
+    * \brief Distance to and index of the closest surface
+    *
+    * The distance of each surface is divided by its Lipschitz constant (see lipschitz_of()), so it is safe to step by the
+    * result even if some surfaces overestimate their distance.
+    */
     [[nodiscard]] std::pair<double, std::size_t>
     evaluate_distance_field(const std::vector<SDFContainer>& surfaces, const vec3& point) noexcept;
 
+    [[nodiscard]] std::pair<double, std::size_t> evaluate_distance_field(const FrozenScene& scene, const vec3& point) noexcept;
+
+    //Single precision version. Only grouped surfaces are evaluated in single precision, so the result may be off by a few ulps
+    [[nodiscard]] std::pair<float, std::size_t>
+    evaluate_distance_field(const FrozenScene& scene, const basic_vec3<float>& point) noexcept;
+
     [[nodiscard]] RaymarchResult raymarch(
         vec3 current_point, const vec3& direction, const std::vector<SDFContainer>& surfaces, RaymarchOptions options) noexcept;
 
+    [[nodiscard]] RaymarchResult
+    raymarch(vec3 current_point, const vec3& direction, const FrozenScene& scene, RaymarchOptions options) noexcept;
+
     [[nodiscard]] vec3 get_normal(const vec3& point, const SDFContainer& surface, double normal_offset = 1e-6) noexcept;
 
 } // namespace Raychel
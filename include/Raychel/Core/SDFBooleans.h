@@ -28,9 +28,15 @@
 #ifndef RAYCHEL_SDF_BOOLEANS_H
 #define RAYCHEL_SDF_BOOLEANS_H
 
+#include "BVH.h"
+#include "SDFBounds.h"
+#include "SDFContainer.h"
+#include "SDFLipschitz.h"
 #include "Types.h"
 
 #include <cmath>
+#include <utility>
+#include <vector>
 
 namespace Raychel {
 
@@ -50,11 +56,89 @@ namespace Raychel {
         return std::min(evaluate_sdf(object.target1, p), evaluate_sdf(object.target2, p));
     }
 
+    template <typename T1, typename T2>
+    AABB evaluate_bounds(const Union<T1, T2>& object) noexcept
+    {
+        return merge(bounds_of(object.target1), bounds_of(object.target2));
+    }
+
+    template <typename T1, typename T2>
+    double evaluate_lipschitz(const Union<T1, T2>& object) noexcept
+    {
+        return std::max(lipschitz_of(object.target1), lipschitz_of(object.target2));
+    }
+
+    /**
+    * \brief Union of any number of type-erased targets
+    *
+    * The bounded targets are kept in a bounding volume hierarchy, so evaluation skips every target whose bounds are further
+    * away than the closest distance found so far. Unbounded targets are always evaluated.
+    */
+    class UnionN
+    {
+    public:
+        explicit UnionN(std::vector<SDFContainer> targets) noexcept;
+
+        [[nodiscard]] const std::vector<SDFContainer>& targets() const noexcept
+        {
+            return targets_;
+        }
+
+        [[nodiscard]] AABB bounds() const noexcept
+        {
+            return bounds_;
+        }
+
+        //Largest Lipschitz constant of all targets
+        [[nodiscard]] double lipschitz_constant() const noexcept
+        {
+            return lipschitz_constant_;
+        }
+
+        //Signed distance to and index of the closest target
+        [[nodiscard]] std::pair<double, std::size_t> closest_target(const vec3& p) const noexcept;
+
+    private:
+        std::vector<SDFContainer> targets_;
+        std::vector<std::size_t> unbounded_targets_{};
+        //Maps leaves of the hierarchy to indices into targets_
+        std::vector<std::size_t> bounded_targets_{};
+        details::BoundingVolumeHierarchy hierarchy_{};
+        AABB bounds_{AABB::empty()};
+        double lipschitz_constant_{1.0};
+    };
+
+    inline double evaluate_sdf(const UnionN& object, const vec3& p) noexcept
+    {
+        return object.closest_target(p).first;
+    }
+
+    inline AABB evaluate_bounds(const UnionN& object) noexcept
+    {
+        return object.bounds();
+    }
+
+    inline double evaluate_lipschitz(const UnionN& object) noexcept
+    {
+        return object.lipschitz_constant();
+    }
+
+    inline std::size_t evaluate_material_index(const UnionN& object, const vec3& p) noexcept
+    {
+        const auto [_, target_index] = object.closest_target(p);
+        if (target_index >= object.targets().size()) {
+            return 0U;
+        }
+        return object.targets()[target_index].material_index(p);
+    }
+
+    //The bounds of target1 are cached on construction, changing target1 afterwards is not allowed
     template <typename Target1, typename Target2>
     struct Difference
     {
         Target1 target1;
         Target2 target2;
+        AABB target1_bounds{bounds_of(target1)};
     };
 
     template <typename T1, typename T2>
@@ -63,14 +147,37 @@ namespace Raychel {
     template <typename T1, typename T2>
     double evaluate_sdf(const Difference<T1, T2>& object, const vec3& p) noexcept
     {
-        return std::max(-evaluate_sdf(object.target1, p), evaluate_sdf(object.target2, p));
+        const auto d2 = evaluate_sdf(object.target2, p);
+
+        //Outside its bounds, target1 is at least that far away and cannot cut anything within -d2 of p
+        const auto target1_lower_bound = distance_to_bounds(object.target1_bounds, p);
+        if (target1_lower_bound > 0.0 && -d2 <= target1_lower_bound) {
+            return d2;
+        }
+
+        return std::max(-evaluate_sdf(object.target1, p), d2);
+    }
+
+    //target1 is cut out of target2, so the result can never be larger than target2
+    template <typename T1, typename T2>
+    AABB evaluate_bounds(const Difference<T1, T2>& object) noexcept
+    {
+        return bounds_of(object.target2);
+    }
+
+    template <typename T1, typename T2>
+    double evaluate_lipschitz(const Difference<T1, T2>& object) noexcept
+    {
+        return std::max(lipschitz_of(object.target1), lipschitz_of(object.target2));
     }
 
+    //The bounds of target2 are cached on construction, changing target2 afterwards is not allowed
     template <typename Target1, typename Target2>
     struct Intersection
     {
         Target1 target1;
         Target2 target2;
+        AABB target2_bounds{bounds_of(target2)};
     };
 
     template <typename T1, typename T2>
@@ -79,7 +186,27 @@ namespace Raychel {
     template <typename T1, typename T2>
     double evaluate_sdf(const Intersection<T1, T2>& object, const vec3& p) noexcept
     {
-        return std::max(evaluate_sdf(object.target1, p), evaluate_sdf(object.target2, p));
+        const auto d1 = evaluate_sdf(object.target1, p);
+
+        //If the bounds of target2 are further away than target1, they are a good enough lower bound for the intersection
+        const auto target2_lower_bound = distance_to_bounds(object.target2_bounds, p);
+        if (target2_lower_bound > 0.0 && target2_lower_bound > d1) {
+            return target2_lower_bound;
+        }
+
+        return std::max(d1, evaluate_sdf(object.target2, p));
+    }
+
+    template <typename T1, typename T2>
+    AABB evaluate_bounds(const Intersection<T1, T2>& object) noexcept
+    {
+        return intersect(bounds_of(object.target1), object.target2_bounds);
+    }
+
+    template <typename T1, typename T2>
+    double evaluate_lipschitz(const Intersection<T1, T2>& object) noexcept
+    {
+        return std::max(lipschitz_of(object.target1), lipschitz_of(object.target2));
     }
 
 } // namespace Raychel
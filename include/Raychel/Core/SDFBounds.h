@@ -0,0 +1,205 @@
+/**
+* \file SDFBounds.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for bounding boxes of SDFs
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_SDF_BOUNDS_H
+#define RAYCHEL_SDF_BOUNDS_H
+
+#include "Types.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace Raychel {
+
+    //Axis aligned bounding box. Every point with a non-positive distance to an object must lie inside the object's bounds
+    struct AABB
+    {
+        [[nodiscard]] static constexpr AABB infinite() noexcept
+        {
+            constexpr auto inf = std::numeric_limits<double>::infinity();
+            return {vec3{-inf, -inf, -inf}, vec3{inf, inf, inf}};
+        }
+
+        [[nodiscard]] static constexpr AABB empty() noexcept
+        {
+            constexpr auto inf = std::numeric_limits<double>::infinity();
+            return {vec3{inf, inf, inf}, vec3{-inf, -inf, -inf}};
+        }
+
+        [[nodiscard]] bool is_finite() const noexcept
+        {
+            return std::isfinite(lower.x()) && std::isfinite(lower.y()) && std::isfinite(lower.z()) &&
+                   std::isfinite(upper.x()) && std::isfinite(upper.y()) && std::isfinite(upper.z());
+        }
+
+        [[nodiscard]] bool is_empty() const noexcept
+        {
+            return lower.x() > upper.x() || lower.y() > upper.y() || lower.z() > upper.z();
+        }
+
+        [[nodiscard]] vec3 center() const noexcept
+        {
+            return (lower + upper) * 0.5;
+        }
+
+        [[nodiscard]] vec3 extent() const noexcept
+        {
+            return upper - lower;
+        }
+
+        vec3 lower{};
+        vec3 upper{};
+    };
+
+    [[nodiscard]] inline AABB merge(const AABB& a, const AABB& b) noexcept
+    {
+        using std::min, std::max;
+        return {
+            vec3{min(a.lower.x(), b.lower.x()), min(a.lower.y(), b.lower.y()), min(a.lower.z(), b.lower.z())},
+            vec3{max(a.upper.x(), b.upper.x()), max(a.upper.y(), b.upper.y()), max(a.upper.z(), b.upper.z())}};
+    }
+
+    [[nodiscard]] inline AABB intersect(const AABB& a, const AABB& b) noexcept
+    {
+        using std::min, std::max;
+        return {
+            vec3{max(a.lower.x(), b.lower.x()), max(a.lower.y(), b.lower.y()), max(a.lower.z(), b.lower.z())},
+            vec3{min(a.upper.x(), b.upper.x()), min(a.upper.y(), b.upper.y()), min(a.upper.z(), b.upper.z())}};
+    }
+
+    [[nodiscard]] inline AABB expand(const AABB& box, double amount) noexcept
+    {
+        return {box.lower - vec3{amount, amount, amount}, box.upper + vec3{amount, amount, amount}};
+    }
+
+    [[nodiscard]] inline AABB translate(const AABB& box, const vec3& translation) noexcept
+    {
+        return {box.lower + translation, box.upper + translation};
+    }
+
+    //Bounds of the rotated box. This is conservative, the result may be larger than the tightest possible box
+    [[nodiscard]] inline AABB rotate(const AABB& box, const Quaternion& rotation) noexcept
+    {
+        if (!box.is_finite() || box.is_empty()) {
+            return box;
+        }
+
+        auto result = AABB::empty();
+        for (std::size_t i{}; i != 8U; ++i) {
+            const vec3 corner{
+                (i & 1U) != 0U ? box.upper.x() : box.lower.x(),
+                (i & 2U) != 0U ? box.upper.y() : box.lower.y(),
+                (i & 4U) != 0U ? box.upper.z() : box.lower.z()};
+            const auto rotated = corner * rotation;
+            result = merge(result, AABB{rotated, rotated});
+        }
+        return result;
+    }
+
+    //Distance between p and the closest point in the box. Zero if p is inside. This is a lower bound for the distance of any
+    //object inside the box
+    [[nodiscard]] inline double distance_to_bounds(const AABB& box, const vec3& p) noexcept
+    {
+        using std::max;
+        const auto dx = max(max(box.lower.x() - p.x(), p.x() - box.upper.x()), 0.0);
+        const auto dy = max(max(box.lower.y() - p.y(), p.y() - box.upper.y()), 0.0);
+        const auto dz = max(max(box.lower.z() - p.z(), p.z() - box.upper.z()), 0.0);
+        return std::sqrt(sq(dx) + sq(dy) + sq(dz));
+    }
+
+    //Range of ray parameters t for which origin + t * direction lies inside a box. Empty if entry > exit
+    struct RayInterval
+    {
+        [[nodiscard]] static constexpr RayInterval empty() noexcept
+        {
+            constexpr auto inf = std::numeric_limits<double>::infinity();
+            return {inf, -inf};
+        }
+
+        [[nodiscard]] bool is_empty() const noexcept
+        {
+            return entry > exit;
+        }
+
+        double entry{};
+        double exit{};
+    };
+
+    //Slab test of the ray against the box. The returned interval may start at a negative t if origin is inside the box
+    [[nodiscard]] inline RayInterval intersect_ray(const AABB& box, const vec3& origin, const vec3& direction) noexcept
+    {
+        constexpr auto inf = std::numeric_limits<double>::infinity();
+
+        RayInterval result{-inf, inf};
+        const auto clip_slab = [&result](double lower, double upper, double o, double d) {
+            if (d == 0.0) {
+                //Parallel to the slab, either always or never inside it
+                if (o < lower || o > upper) {
+                    result = RayInterval::empty();
+                }
+                return;
+            }
+            const auto t1 = (lower - o) / d;
+            const auto t2 = (upper - o) / d;
+            result.entry = std::max(result.entry, std::min(t1, t2));
+            result.exit = std::min(result.exit, std::max(t1, t2));
+        };
+
+        clip_slab(box.lower.x(), box.upper.x(), origin.x(), direction.x());
+        clip_slab(box.lower.y(), box.upper.y(), origin.y(), direction.y());
+        clip_slab(box.lower.z(), box.upper.z(), origin.z(), direction.z());
+
+        if (box.is_empty()) {
+            return RayInterval::empty();
+        }
+        return result;
+    }
+
+    template <typename T>
+    constexpr bool has_bounds_v = requires(const T& t)
+    {
+        {
+            evaluate_bounds(t)
+            } -> std::same_as<AABB>;
+    };
+
+    //Bounds of any object. Objects without an evaluate_bounds function are considered to be unbounded
+    template <typename T>
+    [[nodiscard]] AABB bounds_of(const T& object) noexcept
+    {
+        if constexpr (has_bounds_v<T>) {
+            return evaluate_bounds(object);
+        } else {
+            return AABB::infinite();
+        }
+    }
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_SDF_BOUNDS_H
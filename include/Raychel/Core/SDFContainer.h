@@ -28,6 +28,9 @@
 #ifndef RAYCHEL_SDF_CONTAINER_H
 #define RAYCHEL_SDF_CONTAINER_H
 
+#include "Raychel/Core/ContainerStorage.h"
+#include "Raychel/Core/SDFBounds.h"
+#include "Raychel/Core/SDFLipschitz.h"
 #include "Raychel/Core/SDFPrimitives.h"
 #include "Types.h"
 
@@ -48,6 +51,15 @@ namespace Raychel {
             } -> std::same_as<vec3>;
     };
 
+    //Objects that consist of multiple parts (like instanced geometry) may select a different material for each part
+    template <typename T>
+    constexpr bool has_material_index_v = requires(T t)
+    {
+        {
+            evaluate_material_index(t, vec3{})
+            } -> std::same_as<std::size_t>;
+    };
+
     namespace details {
 
         template <typename T>
@@ -75,6 +87,16 @@ namespace Raychel {
 
             virtual void debug_log() const noexcept = 0;
 
+            //Move-construct this implementation at storage and return the new object
+            [[nodiscard]] virtual ISDFContainerImpl* move_to(void* storage) noexcept = 0;
+
+            [[nodiscard]] virtual std::size_t storage_size() const noexcept = 0;
+
+            [[nodiscard]] virtual std::size_t storage_alignment() const noexcept = 0;
+
+            //Move the implementations of all type-erased targets into the arena
+            virtual void move_targets_into(ContainerArena& arena) noexcept = 0;
+
             virtual ~ISDFContainerImpl() = default;
         };
 
@@ -107,6 +129,30 @@ namespace Raychel {
                 return TypeId<T>::id();
             }
 
+            [[nodiscard]] ISDFContainerImpl* move_to(void* storage) noexcept override
+            {
+                return new (storage) SDFContainerImpl{std::move(object_)};
+            }
+
+            [[nodiscard]] std::size_t storage_size() const noexcept override
+            {
+                return sizeof(SDFContainerImpl);
+            }
+
+            [[nodiscard]] std::size_t storage_alignment() const noexcept override
+            {
+                return alignof(SDFContainerImpl);
+            }
+
+            void move_targets_into([[maybe_unused]] ContainerArena& arena) noexcept override
+            {
+                if constexpr (has_target_v<T>) {
+                    if constexpr (std::is_same_v<decltype(T::target), SDFContainer>) {
+                        object_.target.move_into(arena);
+                    }
+                }
+            }
+
             [[nodiscard]] T& object() noexcept
             {
                 return object_;
@@ -141,6 +187,19 @@ namespace Raychel {
                 RAYCHEL_ASSERT_NOT_REACHED;
             }
 
+            static AABB get_bounds(ISDFContainerImpl* ptr)
+            {
+                return bounds_of(get_ref(ptr));
+            }
+
+            static std::size_t get_material_index(ISDFContainerImpl* ptr, const vec3& p)
+            {
+                if constexpr (has_material_index_v<T>) {
+                    return evaluate_material_index(get_ref(ptr), p);
+                }
+                return 0U;
+            }
+
             static T& get_ref(ISDFContainerImpl* ptr)
             {
                 return reinterpret_cast<SDFContainerImpl<T>*>(ptr)->object();
@@ -152,6 +211,13 @@ namespace Raychel {
     {
         using EvalFunction = double (*)(details::ISDFContainerImpl*, const vec3&);
         using NormalFunction = vec3 (*)(details::ISDFContainerImpl*, const vec3&);
+        using BoundsFunction = AABB (*)(details::ISDFContainerImpl*);
+        using MaterialIndexFunction = std::size_t (*)(details::ISDFContainerImpl*, const vec3&);
+
+        //Large enough for all primitives and a single transform of a primitive, like Translate<Box>
+        static constexpr std::size_t inline_storage_size{64U};
+
+        using Storage = details::ContainerStorage<details::ISDFContainerImpl, inline_storage_size>;
 
     public:
         template <typename T>
@@ -160,11 +226,16 @@ namespace Raychel {
         template <typename T>
         requires(!std::is_same_v<std::remove_all_extents_t<T>, SDFContainer>) //otherwise the move constructor would be hidden
             explicit SDFContainer(T&& object) noexcept(std::is_nothrow_move_constructible_v<T>)
-            : impl_{std::make_unique<Impl<T>>(std::forward<T>(object))},
+            : storage_{std::in_place_type<Impl<T>>, std::forward<T>(object)},
               eval_{details::Eval<T>::eval},
               get_normal_(details::Eval<T>::get_normal),
+              get_bounds_{details::Eval<T>::get_bounds},
+              get_material_index_{details::Eval<T>::get_material_index},
+              lipschitz_constant_{lipschitz_of(details::Eval<T>::get_ref(storage_.get()))},
               has_custom_normal_{has_custom_normal_v<T>}
-        {}
+        {
+            RAYCHEL_ASSERT(lipschitz_constant_ > 0.0);
+        }
 
         RAYCHEL_MAKE_NONCOPY(SDFContainer)
 
@@ -172,7 +243,7 @@ namespace Raychel {
 
         [[nodiscard]] double evaluate(const vec3& p) const noexcept
         {
-            return eval_(impl_.get(), p);
+            return eval_(storage_.get(), p);
         }
 
         [[nodiscard]] bool has_custom_normal() const noexcept
@@ -182,25 +253,59 @@ namespace Raychel {
 
         [[nodiscard]] vec3 get_normal(const vec3& p) const noexcept
         {
-            return get_normal_(impl_.get(), p);
+            return get_normal_(storage_.get(), p);
+        }
+
+        //Bounds of the contained object. Unbounded objects return AABB::infinite()
+        [[nodiscard]] AABB bounds() const noexcept
+        {
+            return get_bounds_(storage_.get());
+        }
+
+        //Index of the material that should be used at point p. Always 0 unless the object provides its own
+        [[nodiscard]] std::size_t material_index(const vec3& p) const noexcept
+        {
+            return get_material_index_(storage_.get(), p);
+        }
+
+        //Distances of the contained object are at most this many times the distance to its surface (see lipschitz_of())
+        [[nodiscard]] double lipschitz_constant() const noexcept
+        {
+            return lipschitz_constant_;
         }
 
         [[nodiscard]] auto type_id() const noexcept
         {
-            return impl_->type_id();
+            return storage_.get()->type_id();
         }
 
         [[nodiscard]] auto* unsafe_impl() const noexcept
         {
-            return impl_.get();
+            return storage_.get();
+        }
+
+        /**
+        * \brief Move the contained object (and all type-erased targets) into the arena
+        *
+        * The arena must outlive this container. References to the contained object are invalidated.
+        */
+        void move_into(details::ContainerArena& arena) noexcept
+        {
+            storage_.move_into(arena);
+            if (storage_.get() != nullptr) {
+                storage_.get()->move_targets_into(arena);
+            }
         }
 
         ~SDFContainer() = default;
 
     private:
-        std::unique_ptr<details::ISDFContainerImpl> impl_{};
+        Storage storage_;
         EvalFunction eval_;
         NormalFunction get_normal_;
+        BoundsFunction get_bounds_;
+        MaterialIndexFunction get_material_index_;
+        double lipschitz_constant_;
         bool has_custom_normal_ : 1 {};
     };
 
@@ -208,6 +313,16 @@ namespace Raychel {
     {
         return obj.evaluate(p);
     }
+
+    inline AABB evaluate_bounds(const SDFContainer& obj)
+    {
+        return obj.bounds();
+    }
+
+    inline double evaluate_lipschitz(const SDFContainer& obj)
+    {
+        return obj.lipschitz_constant();
+    }
 } // namespace Raychel
 
 #endif //! RAYCHEL_SDF_CONTAINER_H
@@ -0,0 +1,172 @@
+/**
+* \file SDFInstancing.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for instanced SDFs
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_SDF_INSTANCING_H
+#define RAYCHEL_SDF_INSTANCING_H
+
+#include "BVH.h"
+#include "SDFContainer.h"
+#include "Types.h"
+
+#include <iostream>
+#include <optional>
+#include <vector>
+
+namespace Raychel {
+
+    struct Instance
+    {
+        vec3 translation{};
+        Quaternion rotation{};
+
+        //Index into the MaterialPalette of the object
+        std::size_t material_index{};
+    };
+
+    /**
+    * \brief Many copies of the same target, each with its own translation, rotation and material index
+    *
+    * The instances are kept in a bounding volume hierarchy, so evaluating the distance only visits instances close to the
+    * query point. The hierarchy is built on construction. Modifying the target does not rebuild it, so changes that make the
+    * target larger are not allowed.
+    */
+    template <typename Target = SDFContainer>
+    class Instanced
+    {
+    public:
+        Instanced(Target _target, std::vector<Instance> instances) noexcept
+            : target{std::move(_target)}, instances_{std::move(instances)}
+        {
+            inverse_rotations_.reserve(instances_.size());
+
+            std::vector<AABB> instance_bounds{};
+            instance_bounds.reserve(instances_.size());
+
+            const auto target_bounds = bounds_of(target);
+            for (const auto& instance : instances_) {
+                inverse_rotations_.emplace_back(inverse(instance.rotation));
+                instance_bounds.emplace_back(translate(rotate(target_bounds, instance.rotation), instance.translation));
+            }
+
+            hierarchy_ = details::BoundingVolumeHierarchy{instance_bounds};
+        }
+
+        [[nodiscard]] const std::vector<Instance>& instances() const noexcept
+        {
+            return instances_;
+        }
+
+        [[nodiscard]] AABB bounds() const noexcept
+        {
+            return hierarchy_.bounds();
+        }
+
+        //Transform p into the local space of the instance with the given index
+        [[nodiscard]] vec3 to_instance_space(std::size_t instance_index, const vec3& p) const noexcept
+        {
+            return (p - instances_[instance_index].translation) * inverse_rotations_[instance_index];
+        }
+
+        //Signed distance to and index of the closest instance
+        [[nodiscard]] std::pair<double, std::size_t> closest_instance(const vec3& p) const noexcept
+        {
+            return hierarchy_.closest(
+                p, [&](std::size_t instance_index) { return evaluate_sdf(target, to_instance_space(instance_index, p)); });
+        }
+
+        Target target;
+
+    private:
+        std::vector<Instance> instances_;
+        std::vector<Quaternion> inverse_rotations_{};
+        details::BoundingVolumeHierarchy hierarchy_{};
+    };
+
+    template <typename T>
+    struct has_target<Instanced<T>> : std::true_type
+    {};
+
+    template <typename T>
+    Instanced(T, std::vector<Instance>) -> Instanced<T>;
+
+    template <typename T>
+    double evaluate_sdf(const Instanced<T>& object, const vec3& p) noexcept
+    {
+        return object.closest_instance(p).first;
+    }
+
+    template <typename T>
+    AABB evaluate_bounds(const Instanced<T>& object) noexcept
+    {
+        return object.bounds();
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Instanced<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
+    template <typename T>
+    std::size_t evaluate_material_index(const Instanced<T>& object, const vec3& p) noexcept
+    {
+        const auto [_, instance_index] = object.closest_instance(p);
+        if (instance_index >= object.instances().size()) {
+            return 0U;
+        }
+        return object.instances()[instance_index].material_index;
+    }
+
+    template <typename T>
+    bool do_serialize(std::ostream& os, const Instanced<T>& object) noexcept
+    {
+        os << object.instances().size();
+        for (const auto& instance : object.instances()) {
+            os << ' ' << instance.translation << ' ' << instance.rotation << ' ' << instance.material_index;
+        }
+        os << '\n';
+        return os.good();
+    }
+
+    template <typename T>
+    std::optional<Instanced<T>> do_deserialize(std::istream& is, SDFContainer target, DeserializationTag<Instanced<T>>) noexcept
+    {
+        std::size_t instance_count{};
+        if (!(is >> instance_count))
+            return std::nullopt;
+
+        std::vector<Instance> instances(instance_count);
+        for (auto& instance : instances) {
+            if (!(is >> instance.translation >> instance.rotation >> instance.material_index))
+                return std::nullopt;
+        }
+        return Instanced<T>{std::move(target), std::move(instances)};
+    }
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_SDF_INSTANCING_H
@@ -0,0 +1,107 @@
+/**
+* \file SDFLipschitz.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for Lipschitz constants of signed distance fields
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_SDF_LIPSCHITZ_H
+#define RAYCHEL_SDF_LIPSCHITZ_H
+
+#include "SDFBounds.h"
+#include "Types.h"
+
+#include <concepts>
+#include <cstdint>
+#include <vector>
+
+namespace Raychel {
+
+    template <typename T>
+    constexpr bool has_lipschitz_constant_v = requires(T t)
+    {
+        {
+            evaluate_lipschitz(t)
+            } -> std::same_as<double>;
+    };
+
+    /**
+    * \brief Lipschitz constant of any object
+    *
+    * The distance of an object may change by at most this factor times the distance between two points. Marching divides
+    * each step by it, so fields that overestimate the distance still never step through a surface. Objects without an
+    * evaluate_lipschitz function are assumed to be exact distance fields, which have a constant of 1.
+    */
+    template <typename T>
+    [[nodiscard]] double lipschitz_of(const T& object) noexcept
+    {
+        if constexpr (has_lipschitz_constant_v<T>) {
+            return evaluate_lipschitz(object);
+        } else {
+            return 1.0;
+        }
+    }
+
+    struct LipschitzValidationOptions
+    {
+        //Number of point pairs sampled per surface
+        std::size_t sample_count{10'000};
+
+        //Maximum distance between the two points of a pair. Short pairs catch local violations
+        double max_pair_distance{0.1};
+
+        //Region that is sampled for unbounded surfaces. Bounded surfaces are sampled around their bounds
+        AABB unbounded_region{vec3{-100, -100, -100}, vec3{100, 100, 100}};
+
+        //Relative amount by which the observed constant may exceed the declared one before it counts as a violation
+        double tolerance{1e-3};
+
+        std::uint64_t seed{1337};
+    };
+
+    struct LipschitzValidationResult
+    {
+        [[nodiscard]] bool is_valid() const noexcept
+        {
+            return violation_count == 0U;
+        }
+
+        double declared_constant{};
+        double observed_constant{};
+        std::size_t violation_count{};
+    };
+
+    /**
+    * \brief Check the declared Lipschitz constant of the surface by sampling pairs of close points
+    *
+    * This can only find violations, not prove their absence. It is meant for debugging custom SDF types.
+    */
+    [[nodiscard]] LipschitzValidationResult
+    validate_lipschitz(const SDFContainer& surface, const LipschitzValidationOptions& options = {}) noexcept;
+
+    //Validate every surface and log a warning for each one that violates its constant. Returns the number of such surfaces
+    std::size_t validate_lipschitz(const std::vector<SDFContainer>& surfaces, const LipschitzValidationOptions& options = {}) noexcept;
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_SDF_LIPSCHITZ_H
@@ -28,6 +28,8 @@
 #ifndef RAYCHEL_SDF_MODIFIERS_H
 #define RAYCHEL_SDF_MODIFIERS_H
 
+#include "Raychel/Core/SDFBounds.h"
+#include "Raychel/Core/SDFLipschitz.h"
 #include "Raychel/Core/Types.h"
 
 namespace Raychel {
@@ -47,6 +49,18 @@ namespace Raychel {
         return std::abs(evaluate_sdf(object.target, p));
     }
 
+    template <typename T>
+    AABB evaluate_bounds(const Hollow<T>& object) noexcept
+    {
+        return bounds_of(object.target);
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Hollow<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
     template <typename Target>
     struct Rounded
     {
@@ -63,6 +77,18 @@ namespace Raychel {
         return evaluate_sdf(object.target, p) - object.radius;
     }
 
+    template <typename T>
+    AABB evaluate_bounds(const Rounded<T>& object) noexcept
+    {
+        return expand(bounds_of(object.target), std::max(object.radius, 0.0));
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Rounded<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
     template <typename Target>
     struct Onion
     {
@@ -79,6 +105,18 @@ namespace Raychel {
         return std::abs(evaluate_sdf(object.target, p)) - object.thickness;
     }
 
+    template <typename T>
+    AABB evaluate_bounds(const Onion<T>& object) noexcept
+    {
+        return expand(bounds_of(object.target), std::max(object.thickness, 0.0));
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Onion<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
 } // namespace Raychel
 
 #endif //!RAYCHEL_SDF_MODIFIERS_H
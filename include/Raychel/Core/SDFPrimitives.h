@@ -28,6 +28,8 @@
 #ifndef RAYCHEL_SDF_PRIMITIVES_H
 #define RAYCHEL_SDF_PRIMITIVES_H
 
+#include "SDFBounds.h"
+#include "SDFLipschitz.h"
 #include "Types.h"
 
 #include <cmath>
@@ -52,6 +54,12 @@ namespace Raychel {
         return normalize(p);
     }
 
+    inline AABB evaluate_bounds(const Sphere& object) noexcept
+    {
+        const vec3 radius{object.radius, object.radius, object.radius};
+        return {-radius, radius};
+    }
+
     bool do_serialize(std::ostream& os, const Sphere& object) noexcept;
 
     std::optional<Sphere> do_deserialize(std::istream& is, DeserializationTag<Sphere>) noexcept;
@@ -69,6 +77,11 @@ namespace Raychel {
         return mag(vec3{max(q.x(), 0.0), max(q.y(), 0.0), max(q.z(), 0.0)}) + min(max(q.x(), max(q.y(), q.z())), 0.0);
     }
 
+    inline AABB evaluate_bounds(const Box& box) noexcept
+    {
+        return {-box.size, box.size};
+    }
+
     bool do_serialize(std::ostream& os, const Box& object) noexcept;
 
     std::optional<Box> do_deserialize(std::istream& is, DeserializationTag<Box>) noexcept;
@@ -88,6 +101,12 @@ namespace Raychel {
         return object.normal;
     }
 
+    //Planes constructed in code may have a normal that is not normalized, which scales the distance
+    inline double evaluate_lipschitz(const Plane& object) noexcept
+    {
+        return mag(object.normal);
+    }
+
     bool do_serialize(std::ostream& os, const Plane& object) noexcept;
 
     std::optional<Plane> do_deserialize(std::istream& is, DeserializationTag<Plane>) noexcept;
@@ -28,9 +28,12 @@
 #ifndef RAYCHEL_SDF_TRANSFORM_H
 #define RAYCHEL_SDF_TRANSFORM_H
 
+#include "AffineTransform.h"
 #include "Types.h"
 #include "SDFContainer.h"
 
+#include "RaychelLogger/Logger.h"
+
 #include <iostream>
 #include <optional>
 
@@ -56,6 +59,18 @@ namespace Raychel {
         return evaluate_sdf(object.target, p - object.translation);
     }
 
+    template <typename T>
+    AABB evaluate_bounds(const Translate<T>& object) noexcept
+    {
+        return translate(bounds_of(object.target), object.translation);
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Translate<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
     template <typename T>
     bool do_serialize(std::ostream& os, const Translate<T>& object) noexcept
     {
@@ -93,6 +108,18 @@ namespace Raychel {
         return evaluate_sdf(object.target, p * inverse(object.rotation));
     }
 
+    template <typename T>
+    AABB evaluate_bounds(const Rotate<T>& object) noexcept
+    {
+        return rotate(bounds_of(object.target), object.rotation);
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Rotate<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
     template <typename T>
     bool do_serialize(std::ostream& os, const Rotate<T>& object) noexcept
     {
@@ -110,6 +137,160 @@ namespace Raychel {
         return Rotate{std::move(target), rotation};
     }
 
+    //Uniform scale. The distance is multiplied by the factor, so the result is still an exact distance
+    template <typename Target = SDFContainer>
+    struct Scale
+    {
+        Target target;
+        double factor{1.0};
+    };
+
+    template <typename T>
+    struct has_target<Scale<T>> : std::true_type
+    {};
+
+    template <typename T>
+    Scale(T, double) -> Scale<T>;
+
+    template <typename T>
+    double evaluate_sdf(const Scale<T>& object, const vec3& p) noexcept
+    {
+        return evaluate_sdf(object.target, p / object.factor) * object.factor;
+    }
+
+    template <typename T>
+    AABB evaluate_bounds(const Scale<T>& object) noexcept
+    {
+        const auto bounds = bounds_of(object.target);
+        return {bounds.lower * object.factor, bounds.upper * object.factor};
+    }
+
+    template <typename T>
+    double evaluate_lipschitz(const Scale<T>& object) noexcept
+    {
+        return lipschitz_of(object.target);
+    }
+
+    template <typename T>
+    bool do_serialize(std::ostream& os, const Scale<T>& object) noexcept
+    {
+        os << object.factor << '\n';
+        return os.good();
+    }
+
+    template <typename T>
+    std::optional<Scale<T>> do_deserialize(std::istream& is, SDFContainer target, DeserializationTag<Scale<T>>) noexcept
+    {
+        double factor{};
+
+        if (!(is >> factor))
+            return std::nullopt;
+        if (!(factor > 0.0)) {
+            Logger::warn("Scale factor must be positive, got ", factor, '\n');
+            return std::nullopt;
+        }
+        return Scale<T>{std::move(target), factor};
+    }
+
+    /**
+    * \brief Arbitrary affine transform of the target
+    *
+    * Stores the matrix and its inverse, so evaluation costs one matrix multiplication no matter how many transforms were
+    * folded into it (see collapse_transforms()). Distances are multiplied by the smallest scale of the transform to stay
+    * conservative. The transform is fixed on construction, so the cached inverse and scale always match it.
+    */
+    template <typename Target = SDFContainer>
+    class Transformed
+    {
+    public:
+        Transformed(Target _target, const AffineTransform& to_world) noexcept
+            : target{std::move(_target)},
+              to_world_{to_world},
+              to_local_{inverse(to_world)},
+              distance_scale_{minimum_scale(to_world)}
+        {}
+
+        [[nodiscard]] const AffineTransform& to_world() const noexcept
+        {
+            return to_world_;
+        }
+
+        [[nodiscard]] const AffineTransform& to_local() const noexcept
+        {
+            return to_local_;
+        }
+
+        //Smallest scale of to_world()
+        [[nodiscard]] double distance_scale() const noexcept
+        {
+            return distance_scale_;
+        }
+
+        Target target;
+
+    private:
+        AffineTransform to_world_;
+        AffineTransform to_local_;
+        double distance_scale_;
+    };
+
+    template <typename T>
+    struct has_target<Transformed<T>> : std::true_type
+    {};
+
+    template <typename T>
+    Transformed(T, AffineTransform) -> Transformed<T>;
+
+    template <typename T>
+    double evaluate_sdf(const Transformed<T>& object, const vec3& p) noexcept
+    {
+        return evaluate_sdf(object.target, apply(object.to_local(), p)) * object.distance_scale();
+    }
+
+    template <typename T>
+    AABB evaluate_bounds(const Transformed<T>& object) noexcept
+    {
+        return transform_bounds(bounds_of(object.target), object.to_world());
+    }
+
+    //Scaling by distance_scale compensates the transform only if it stretches all directions equally
+    template <typename T>
+    double evaluate_lipschitz(const Transformed<T>& object) noexcept
+    {
+        return lipschitz_of(object.target) * object.distance_scale() * maximum_scale(object.to_local());
+    }
+
+    template <typename T>
+    bool do_serialize(std::ostream& os, const Transformed<T>& object) noexcept
+    {
+        os << object.to_world() << '\n';
+        return os.good();
+    }
+
+    template <typename T>
+    std::optional<Transformed<T>>
+    do_deserialize(std::istream& is, SDFContainer target, DeserializationTag<Transformed<T>>) noexcept
+    {
+        AffineTransform to_world{};
+
+        if (!(is >> to_world))
+            return std::nullopt;
+        if (determinant(to_world) == 0.0) {
+            Logger::warn("Cannot deserialize singular transform\n");
+            return std::nullopt;
+        }
+        return Transformed<T>{std::move(target), to_world};
+    }
+
+    /**
+    * \brief Fold a chain of Translate<>, Rotate<> and Scale<> (and Transformed<>) into a single transform
+    *
+    * Only chains of type-erased transforms are folded, which is what deserialization produces. Chains of pure translations
+    * become a single Translate<>, everything else becomes a Transformed<>. Objects that do not start with such a chain are
+    * returned unchanged.
+    */
+    [[nodiscard]] SDFContainer collapse_transforms(SDFContainer object) noexcept;
+
 } // namespace Raychel
 
 #endif //!RAYCHEL_SDF_TRANSFORM_H
@@ -29,6 +29,7 @@
 #define RAYCHEL_PREDEFINED_SIGNED_DISTANCE_FUNCTIONS_H
 
 #include "SDFBooleans.h"
+#include "SDFInstancing.h"
 #include "SDFModifiers.h"
 #include "SDFPrimitives.h"
 #include "SDFTransforms.h"
@@ -34,10 +34,12 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <vector>
 
 namespace Raychel {
 
+    //References into a Scene. They are invalidated by adding or removing objects and by Scene::compact_storage()
     template <typename Object, typename Material>
     struct RaymarchableObject
     {
@@ -55,6 +57,14 @@ namespace Raychel {
     public:
         Scene() = default;
 
+        RAYCHEL_MAKE_NONCOPY(Scene)
+
+        Scene(Scene&&) noexcept = default;
+
+        Scene& operator=(Scene&& other) noexcept;
+
+        ~Scene() = default;
+
         static Scene unsafe_from_data(
             std::vector<SDFContainer> objects, std::vector<SerializableObjectData<SDFContainer>> object_serializers,
             std::vector<MaterialContainer> materials,
@@ -85,6 +95,23 @@ namespace Raychel {
 
         void remove_object(std::size_t index) noexcept;
 
+        /**
+        * \brief Move all objects and materials into one contiguous arena
+        *
+        * Objects are placed in evaluation order, followed by the materials. This keeps the type-erased implementations
+        * close together in memory, which helps the renderer when the scene contains many objects. Should be called once all
+        * objects have been added. Invalidates all references returned by add_object().
+        */
+        void compact_storage() noexcept;
+
+        /**
+        * \brief Fold chains of Translate<>, Rotate<> and Scale<> into a single transform, see collapse_transforms(SDFContainer)
+        *
+        * Objects may change their type, so the scene is sorted again afterwards. Reading a serialized scene back requires
+        * Transformed<> to be registered with the deserializer. Invalidates all references returned by add_object().
+        */
+        void collapse_transforms() noexcept;
+
         template <std::invocable<const RenderData&> F>
         requires(std::is_same_v<std::invoke_result_t<F, const RenderData&>, color>) void set_background_function(F&& f) noexcept
         {
@@ -129,6 +156,8 @@ namespace Raychel {
         std::vector<SerializableObjectData<SDFContainer>> object_serializers_{};
         std::vector<SerializableObjectData<MaterialContainer>> material_serializers_{};
 
+        //Must be declared before the containers so it outlives them
+        std::unique_ptr<details::ContainerArena> arena_{};
         std::vector<SDFContainer> objects_{};
         std::vector<MaterialContainer> materials_{};
         BackgroundFunction background_function_{};
@@ -0,0 +1,123 @@
+/**
+* \file SceneBuilder.h
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Header file for SceneBuilder class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#ifndef RAYCHEL_SCENE_BUILDER_H
+#define RAYCHEL_SCENE_BUILDER_H
+
+#include "Scene.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace Raychel {
+
+    /**
+    * \brief Helper for building large scenes
+    *
+    * Scene::add_object keeps the objects sorted by type on every insertion, which makes building a scene quadratic in the
+    * number of objects. The SceneBuilder instead appends every object to a bucket for its type and only merges the buckets
+    * when build() is called.
+    *
+    * The resulting scene has the same order as one built by calling Scene::add_object in the same sequence: sorted by type,
+    * and the most recently added object of each type first.
+    */
+    class SceneBuilder
+    {
+        struct Bucket
+        {
+            std::vector<SDFContainer> objects{};
+            std::vector<SerializableObjectData<SDFContainer>> object_serializers{};
+            std::vector<MaterialContainer> materials{};
+            std::vector<SerializableObjectData<MaterialContainer>> material_serializers{};
+        };
+
+    public:
+        SceneBuilder() = default;
+
+        //Reserve space for object_count objects of type Object
+        template <typename Object>
+        void reserve(std::size_t object_count) noexcept
+        {
+            auto& bucket = _bucket_for(details::TypeId<Object>::id());
+            bucket.objects.reserve(object_count);
+            bucket.object_serializers.reserve(object_count);
+            bucket.materials.reserve(object_count);
+            bucket.material_serializers.reserve(object_count);
+        }
+
+        template <typename Object, typename Material>
+        void add_object(Object&& object, Material&& material) noexcept
+        {
+            auto& bucket = _bucket_for(details::TypeId<Object>::id());
+
+            bucket.objects.emplace_back(std::forward<Object>(object));
+            bucket.materials.emplace_back(std::forward<Material>(material));
+            bucket.object_serializers.emplace_back(details::SerializableObjectDescriptor<Object>{});
+            bucket.material_serializers.emplace_back(details::SerializableObjectDescriptor<Material>{});
+
+            ++object_count_;
+        }
+
+        template <std::invocable<const RenderData&> F>
+        requires(std::is_same_v<std::invoke_result_t<F, const RenderData&>, color>) void set_background_function(F&& f) noexcept
+        {
+            background_function_ = std::forward<F>(f);
+        }
+
+        [[nodiscard]] std::size_t object_count() const noexcept
+        {
+            return object_count_;
+        }
+
+        //Merge all buckets into a Scene. The builder is empty afterwards
+        [[nodiscard]] Scene build() noexcept;
+
+    private:
+        Bucket& _bucket_for(std::uintptr_t type_id) noexcept
+        {
+            //Procedurally generated scenes usually add many objects of the same type in a row
+            if (last_bucket_ != nullptr && last_type_id_ == type_id) {
+                return *last_bucket_;
+            }
+            last_type_id_ = type_id;
+            last_bucket_ = &buckets_[type_id];
+            return *last_bucket_;
+        }
+
+        //std::map keeps the buckets sorted by type id, which is the order Scene expects
+        std::map<std::uintptr_t, Bucket> buckets_{};
+        std::uintptr_t last_type_id_{};
+        Bucket* last_bucket_{nullptr};
+
+        std::size_t object_count_{};
+        BackgroundFunction background_function_{};
+    };
+
+} // namespace Raychel
+
+#endif //!RAYCHEL_SCENE_BUILDER_H
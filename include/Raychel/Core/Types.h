@@ -46,6 +46,8 @@ namespace Raychel {
 
     class SDFContainer;
 
+    class FrozenScene;
+
     class Scene;
 
     struct RenderData;
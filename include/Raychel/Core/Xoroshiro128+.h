@@ -48,6 +48,9 @@ namespace Raychel {
         };
 
     public:
+        //Makes this a UniformRandomBitGenerator, so it works with all standard distributions
+        using result_type = std::uint64_t;
+
         static constexpr std::int32_t A = 24, B = 16, C = 37;
 
         constexpr Xoroshiro128() = default;
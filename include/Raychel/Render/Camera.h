@@ -30,6 +30,8 @@
 
 #include "Raychel/Core/Types.h"
 
+#include <optional>
+
 namespace Raychel {
 
     struct Camera
@@ -38,6 +40,67 @@ namespace Raychel {
         double zoom{1.0};
     };
 
+    /**
+    * \brief Direction of the primary ray through the pixel in column x and row y (counted from the top), without antialiasing
+    *
+    * The direction is in camera space. Multiply it by camera.transform.rotation to get the world space direction.
+    */
+    [[nodiscard]] inline vec3 get_primary_ray_direction(const Camera& camera, Size2D output_size, std::size_t x, std::size_t y) noexcept
+    {
+        constexpr vec3 right{1, 0, 0};
+        constexpr vec3 up{0, 1, 0};
+        constexpr vec3 forward{0, 0, 1};
+
+        const auto [plane_x, plane_y] = output_size;
+        const auto aspect_ratio = static_cast<double>(plane_x) / static_cast<double>(plane_y);
+
+        //Rows are counted from the top, the image plane goes up
+        const auto raw_relative_x = static_cast<double>(x) / static_cast<double>(plane_x) - 0.5;
+        const auto raw_relative_y = static_cast<double>(plane_y - y) / static_cast<double>(plane_y) - 0.5;
+
+        auto relative_x = raw_relative_x;
+        auto relative_y = raw_relative_y;
+        if (aspect_ratio > 1.0) {
+            relative_x *= aspect_ratio;
+        } else {
+            relative_y /= aspect_ratio;
+        }
+
+        // clang-format off
+        return normalize(   (right * relative_x) +
+                            (up * relative_y)    +
+                            (forward * camera.zoom));
+        // clang-format on
+    }
+
+    /**
+    * \brief Inverse of get_primary_ray_direction(): the fractional column and row at which the camera sees a camera space direction
+    *
+    * Returns std::nullopt if the direction does not point in front of the camera. The result may lie outside of the image.
+    */
+    [[nodiscard]] inline std::optional<basic_vec2<double>>
+    project_to_pixel(const Camera& camera, Size2D output_size, const vec3& direction) noexcept
+    {
+        if (direction.z() <= 0.0) {
+            return std::nullopt;
+        }
+
+        const auto [plane_x, plane_y] = output_size;
+        const auto aspect_ratio = static_cast<double>(plane_x) / static_cast<double>(plane_y);
+
+        auto raw_relative_x = direction.x() * camera.zoom / direction.z();
+        auto raw_relative_y = direction.y() * camera.zoom / direction.z();
+        if (aspect_ratio > 1.0) {
+            raw_relative_x /= aspect_ratio;
+        } else {
+            raw_relative_y *= aspect_ratio;
+        }
+
+        return basic_vec2<double>{
+            (raw_relative_x + 0.5) * static_cast<double>(plane_x),
+            static_cast<double>(plane_y) - (raw_relative_y + 0.5) * static_cast<double>(plane_y)};
+    }
+
 } // namespace Raychel
 
 #endif //!RAYCHEL_CAMERA_H
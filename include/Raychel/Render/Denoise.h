@@ -30,6 +30,10 @@
 
 #include "FatPixel.h"
 #include "Framebuffer.h"
+#include "Renderer.h"
+
+#include <functional>
+#include <span>
 
 namespace Raychel {
 
@@ -39,11 +43,87 @@ namespace Raychel {
         std::size_t half_search_window_size{6};
         double distance_threshold{1.};
         std::size_t num_scales{3};
+
+        //If not 0, the search window is searched with PatchMatch, keeping this many of the most similar patches per pixel.
+        //The cost barely depends on the window size, so it pays off for windows larger than about 19x19 pixels
+        std::size_t num_patch_matches{0};
+        //Number of propagation and random search passes of PatchMatch. More than 2 rarely improve the result
+        std::size_t patch_match_iterations{2};
+
+        //denoise_temporal() compares each patch with the patches up to this far from its position in every earlier frame
+        std::size_t half_temporal_window_size{1};
+        //Reprojected pixels are dropped if the earlier frame saw them at a depth that is off by more than this fraction
+        double max_reprojection_depth_error{0.02};
     };
 
-    Framebuffer denoise_single_scale(const FatFramebuffer& input_pixels, DenoisingOptions options = {}) noexcept;
+    //Pixel can be FatPixel, FloatFatPixel or CompactFatPixel
+    template <typename Pixel>
+    Framebuffer denoise_single_scale(const details::BasicFramebuffer<Pixel>& input_pixels, DenoisingOptions options = {}) noexcept;
+
+    template <typename Pixel>
+    Framebuffer denoise_multiscale(const details::BasicFramebuffer<Pixel>& input_pixels, DenoisingOptions options = {}) noexcept;
+
+    //Called from a denoising thread with the bounds [begin, end) of every tile of output whose pixels are final
+    using DenoisedTileCallback = std::function<void(Size2D begin, Size2D end, const Framebuffer& output)>;
+
+    /**
+    * \brief Render the scene and denoise it like denoise_single_scale(), overlapping the two
+    *
+    * Each tile of the image is denoised as soon as all pixels its patches and search windows read have been rendered, while
+    * the rest of the image is still being rendered. Multiscale denoising needs the whole image and cannot be streamed.
+    */
+    template <typename Pixel>
+    Framebuffer render_and_denoise(
+        const Scene& scene, const Camera& camera, const RenderOptions& render_options, DenoisingOptions options = {},
+        const DenoisedTileCallback& on_tile_denoised = {}) noexcept;
+
+    //One frame of an animation, rendered with render_scene_with_features()
+    template <typename Pixel>
+    struct AnimationFrame
+    {
+        const details::BasicFramebuffer<Pixel>& pixels;
+        const FeatureBuffer& features;
+        Camera camera{};
+    };
+
+    /**
+    * \brief Denoise a frame of an animation like denoise_single_scale(), also taking matching patches from earlier frames
+    *
+    * Each earlier frame is reprojected onto the current one using the camera motion and the depth of the first hit of every
+    * pixel. Pixels whose surface was hidden or has moved in between are left out. Every patch is then compared with the
+    * patches within half_temporal_window_size of its position in each reprojected frame, in addition to the patches of the
+    * current frame. All frames must have the same size.
+    */
+    template <typename Pixel>
+    Framebuffer denoise_temporal(
+        const AnimationFrame<Pixel>& current_frame, std::span<const AnimationFrame<Pixel>> previous_frames,
+        DenoisingOptions options = {}) noexcept;
+
+    struct FeatureDenoisingOptions
+    {
+        //Number of filter passes. The filter reaches 2^(num_iterations + 1) - 2 pixels in each direction
+        std::size_t num_iterations{5};
+        //How much the colors of two pixels may differ. Halved with every pass, and widened by the variance of MomentPixels
+        double color_sigma{0.5};
+        //How much the squared distance between the normals of two pixels may be
+        double normal_sigma{0.1};
+        //How much the depths of two pixels may differ, relative to the depth of the center pixel
+        double depth_sigma{0.05};
+        //How much the albedos of two pixels may differ
+        double albedo_sigma{0.1};
+    };
 
-    Framebuffer denoise_multiscale(const FatFramebuffer& input_pixels, DenoisingOptions options = {}) noexcept;
+    /**
+    * \brief Denoise using the features from render_scene_with_features() to find edges
+    *
+    * Runs the edge-avoiding A-Trous wavelet filter, which takes milliseconds instead of the minutes of the histogram based
+    * denoisers and works with every pixel type, including MomentPixel. Pixels of different objects are never mixed. The
+    * result is blurrier than that of denoise_multiscale(), so it is best suited for previews and animations.
+    */
+    template <typename Pixel>
+    Framebuffer denoise_with_features(
+        const details::BasicFramebuffer<Pixel>& input_pixels, const FeatureBuffer& features,
+        FeatureDenoisingOptions options = {}) noexcept;
 
 } // namespace Raychel
 
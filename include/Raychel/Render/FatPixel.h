@@ -30,15 +30,33 @@
 
 #include "RayHistogram.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 namespace Raychel {
 
     namespace details {
-        template <std::size_t NumBins>
+        //Pixels are filled by calling add_sample() once for each of the samples_per_pixel samples, or add_samples() for several at once
+        template <std::size_t NumBins, typename BinType = double>
         struct FatPixel
         {
-            using Histogram = RayHistogram<NumBins>;
+            using Histogram = RayHistogram<NumBins, BinType>;
+
+            void add_sample(const color& sample, std::size_t samples_per_pixel) noexcept
+            {
+                histogram.add_sample(sample);
+                noisy_color += (sample / samples_per_pixel);
+            }
+
+            void add_samples(std::span<const color> samples, std::size_t samples_per_pixel) noexcept
+            {
+                histogram.add_samples(samples);
+                for (const auto& sample : samples) {
+                    noisy_color += (sample / samples_per_pixel);
+                }
+            }
 
             FatPixel operator+(const FatPixel& other) const noexcept
             {
@@ -55,10 +73,53 @@ namespace Raychel {
             Histogram histogram{};
         };
 
+        //Pixel without a histogram, for renders that are not denoised with the histogram based denoiser
+        struct MomentPixel
+        {
+            void add_sample(const color& sample, std::size_t samples_per_pixel) noexcept
+            {
+                noisy_color += (sample / samples_per_pixel);
+                second_moment += (sample * sample) / samples_per_pixel;
+                ++sample_count;
+            }
+
+            void add_samples(std::span<const color> samples, std::size_t samples_per_pixel) noexcept
+            {
+                for (const auto& sample : samples) {
+                    add_sample(sample, samples_per_pixel);
+                }
+            }
+
+            //Unbiased sample variance of each channel
+            [[nodiscard]] color variance() const noexcept
+            {
+                if (sample_count < 2U) {
+                    return color{};
+                }
+                const auto n = static_cast<double>(sample_count);
+                const auto biased = second_moment - (noisy_color * noisy_color);
+                return color{std::max(biased.r(), 0.0), std::max(biased.g(), 0.0), std::max(biased.b(), 0.0)} * (n / (n - 1.0));
+            }
+
+            //Mean of the samples
+            color noisy_color{};
+            //Mean of the squared samples
+            color second_moment{};
+            std::uint32_t sample_count{};
+        };
+
     } // namespace details
 
     using FatPixel = details::FatPixel<30U>;
 
+    //Same as FatPixel with single precision bins
+    using FloatFatPixel = details::FatPixel<30U, float>;
+
+    //Same as FatPixel with 16 bit bins that share a scale. 224 instead of 792 bytes, less than a third of the size of a FatPixel
+    using CompactFatPixel = details::FatPixel<30U, std::uint16_t>;
+
+    using MomentPixel = details::MomentPixel;
+
 } // namespace Raychel
 
 #endif //!RAYCHEL_FAT_PIXEL_H
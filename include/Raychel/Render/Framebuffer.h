@@ -71,6 +71,9 @@ namespace Raychel {
 
     using Framebuffer = details::BasicFramebuffer<color>;
     using FatFramebuffer = details::BasicFramebuffer<FatPixel>;
+    using FloatFatFramebuffer = details::BasicFramebuffer<FloatFatPixel>;
+    using CompactFatFramebuffer = details::BasicFramebuffer<CompactFatPixel>;
+    using MomentFramebuffer = details::BasicFramebuffer<MomentPixel>;
 
 } // namespace Raychel
 
@@ -30,11 +30,14 @@
 
 #include "Materials.h"
 
+#include "Raychel/Core/ContainerStorage.h"
 #include "Raychel/Core/Types.h"
 #include "RaychelCore/Badge.h"
 #include "RaychelCore/ClassMacros.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 namespace Raychel {
 
@@ -50,6 +53,15 @@ namespace Raychel {
 
             [[nodiscard]] virtual double get_material_ior_internal() const noexcept = 0;
 
+            [[nodiscard]] virtual color get_material_albedo_internal(const ShadingData& data) const noexcept = 0;
+
+            //Move-construct this implementation at storage and return the new object
+            [[nodiscard]] virtual IMaterialContainerImpl* move_to(void* storage) noexcept = 0;
+
+            [[nodiscard]] virtual std::size_t storage_size() const noexcept = 0;
+
+            [[nodiscard]] virtual std::size_t storage_alignment() const noexcept = 0;
+
             virtual ~IMaterialContainerImpl() = default;
         };
 
@@ -73,6 +85,28 @@ namespace Raychel {
                 return 1.0;
             }
 
+            [[nodiscard]] color get_material_albedo_internal(const ShadingData& data) const noexcept override
+            {
+                if constexpr (material_with_albedo<T>)
+                    return get_material_albedo(object_, data);
+                return color{1};
+            }
+
+            [[nodiscard]] IMaterialContainerImpl* move_to(void* storage) noexcept override
+            {
+                return new (storage) MaterialContainerImpl{std::move(object_)};
+            }
+
+            [[nodiscard]] std::size_t storage_size() const noexcept override
+            {
+                return sizeof(MaterialContainerImpl);
+            }
+
+            [[nodiscard]] std::size_t storage_alignment() const noexcept override
+            {
+                return alignof(MaterialContainerImpl);
+            }
+
             [[nodiscard]] T& object() noexcept
             {
                 return object_;
@@ -91,6 +125,11 @@ namespace Raychel {
 
     class MaterialContainer
     {
+        //Large enough for materials made of a few colors and scalars
+        static constexpr std::size_t inline_storage_size{64U};
+
+        using Storage = details::ContainerStorage<details::IMaterialContainerImpl, inline_storage_size>;
+
     public:
         template <typename T>
         using Impl = details::MaterialContainerImpl<T>;
@@ -98,7 +137,7 @@ namespace Raychel {
         template <typename T>
         requires(!std::is_same_v<T, MaterialContainer>) explicit MaterialContainer(T&& object) noexcept(
             std::is_nothrow_move_constructible_v<T>)
-            : impl_{std::make_unique<details::MaterialContainerImpl<T>>(std::forward<T>(object))}
+            : storage_{std::in_place_type<Impl<T>>, std::forward<T>(object)}
         {}
 
         RAYCHEL_MAKE_NONCOPY(MaterialContainer)
@@ -106,25 +145,61 @@ namespace Raychel {
 
         [[nodiscard]] color get_surface_color(const ShadingData& data) const noexcept
         {
-            return impl_->get_surface_color_internal(data);
+            return storage_.get()->get_surface_color_internal(data);
         }
 
         [[nodiscard]] double get_material_ior() const noexcept
         {
-            return impl_->get_material_ior_internal();
+            return storage_.get()->get_material_ior_internal();
+        }
+
+        //Base color of the material, or white if it does not have one
+        [[nodiscard]] color get_material_albedo(const ShadingData& data) const noexcept
+        {
+            return storage_.get()->get_material_albedo_internal(data);
         }
 
         [[nodiscard]] auto* unsafe_impl() const noexcept
         {
-            return impl_.get();
+            return storage_.get();
+        }
+
+        //Move the contained material into the arena. The arena must outlive this container
+        void move_into(details::ContainerArena& arena) noexcept
+        {
+            storage_.move_into(arena);
         }
 
         ~MaterialContainer() = default;
 
     private:
-        std::unique_ptr<details::IMaterialContainerImpl> impl_{};
+        Storage storage_;
+    };
+
+    //Material that forwards to one of several materials, selected by the material index of the surface (see Instanced<T>)
+    struct MaterialPalette
+    {
+        std::vector<MaterialContainer> materials{};
     };
 
+    inline color get_surface_color(const MaterialPalette& palette, const ShadingData& data) noexcept
+    {
+        if (palette.materials.empty()) {
+            return get_surface_color(DeserializationErrorMaterial{}, data);
+        }
+        const auto index = std::min(data.material_index, palette.materials.size() - 1U);
+        return palette.materials[index].get_surface_color(data);
+    }
+
+    inline color get_material_albedo(const MaterialPalette& palette, const ShadingData& data) noexcept
+    {
+        if (palette.materials.empty()) {
+            return get_material_albedo(DeserializationErrorMaterial{}, data);
+        }
+        const auto index = std::min(data.material_index, palette.materials.size() - 1U);
+        return palette.materials[index].get_material_albedo(data);
+    }
+
 } //namespace Raychel
 
 #endif //!RAYCHEL_MATERIAL_CONTAINER_H
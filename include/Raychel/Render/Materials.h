@@ -31,6 +31,7 @@
 #include "Raychel/Core/Types.h"
 
 #include <cmath>
+#include <concepts>
 
 namespace Raychel {
 
@@ -44,6 +45,9 @@ namespace Raychel {
 
         const RenderState& state;
         std::size_t recursion_depth;
+
+        //Material index reported by the surface at position. Only used by materials like MaterialPalette
+        std::size_t material_index{};
     };
 
     template <typename T>
@@ -61,6 +65,20 @@ namespace Raychel {
         return color{1, 0, 1};
     }
 
+    constexpr color get_material_albedo(DeserializationErrorMaterial /*unused*/, const ShadingData& /*unused*/) noexcept
+    {
+        return color{1, 0, 1};
+    }
+
+    //Materials can report their base color through get_material_albedo(material, data). It only guides denoising
+    template <typename T>
+    concept material_with_albedo = requires(const T& material, const ShadingData& data)
+    {
+        {
+            get_material_albedo(material, data)
+            } -> std::convertible_to<color>;
+    };
+
 } // namespace Raychel
 
 #endif //!RAYCHEL_MATERIALS_H
@@ -47,6 +47,8 @@ namespace Raychel {
 
     [[nodiscard]] color get_shaded_color(const RenderData& data) noexcept;
 
+    [[nodiscard]] PixelFeatures get_pixel_features(const RenderData& data) noexcept;
+
     [[nodiscard]] color get_diffuse_lighting(const ShadingData& data) noexcept;
 
     [[nodiscard]] color get_refraction(const RefractionData& data) noexcept;
@@ -31,9 +31,11 @@
 #include "Camera.h"
 #include "Framebuffer.h"
 #include "MaterialContainer.h"
+#include "Raychel/Core/Raymarch.h"
 #include "Raychel/Core/SDFContainer.h"
 
 #include <functional>
+#include <utility>
 #include <vector>
 
 namespace Raychel {
@@ -64,6 +66,22 @@ namespace Raychel {
         //Maximum distance a ray can travel
         double max_ray_depth{500};
 
+        //Resolution of the grid used to skip empty space. If 0, no grid is used
+        std::size_t distance_grid_resolution{64};
+
+        //Size of the screen tiles for which invisible objects are culled from primary rays. If 0, no culling is done
+        std::size_t culling_tile_size{32};
+
+        //If primary rays start at a depth found by marching cones through blocks of pixels first
+        bool cone_march_primary_rays{true};
+
+        //If rays are marched in single precision while they are far away from all surfaces. Hits are still found in double
+        //precision. Only faster if the distance kernels are vectorized (e.g. with AVX-512), so this is opt-in
+        bool mixed_precision_marching{false};
+
+        //Debugging aid: sample every surface before rendering and warn about those that change faster than their Lipschitz constant allows
+        bool validate_lipschitz_constants{false};
+
         //Maximum distance between the ray and a surface
         double surface_epsilon{1e-6};
         //Radius used for normal calculation. Should be smaller than surface_epsilon to avoid weirdness
@@ -76,6 +94,7 @@ namespace Raychel {
     {
         const std::vector<SDFContainer>& surfaces;
         const std::vector<MaterialContainer>& materials;
+        const FrozenScene& frozen_surfaces;
         BackgroundFunction get_background{};
         RenderOptions options{};
     };
@@ -86,10 +105,62 @@ namespace Raychel {
 
         const RenderState& state;
         std::size_t recursion_depth;
+
+        //Subset of the scene that is visible to this ray. Only set for primary rays, all other rays see the whole scene
+        const FrozenScene* primary_surfaces{nullptr};
+
+        //Distance along the ray that is known to be free of surfaces. Marching starts there
+        double start_depth{};
+    };
+
+    //The first surface seen through the center of a pixel
+    struct PixelFeatures
+    {
+        //Surface normal, or zero if the ray hit the background
+        vec3 normal{};
+        //Distance from the camera, or zero if the ray hit the background
+        double depth{};
+        color albedo{};
+        std::size_t object_index{no_hit};
     };
 
+    using FeatureBuffer = details::BasicFramebuffer<PixelFeatures>;
+
     FatFramebuffer render_scene(const Scene& scene, const Camera& camera, const RenderOptions& options = {}) noexcept;
 
+    /**
+    * \brief Render into a framebuffer of the given pixel type
+    *
+    * Pixel can be FatPixel, FloatFatPixel, CompactFatPixel or MomentPixel. The smaller fat pixels trade histogram precision
+    * for memory, MomentPixels do not store a histogram at all and cannot be denoised with denoise_single_scale() and friends.
+    */
+    template <typename Pixel>
+    [[nodiscard]] details::BasicFramebuffer<Pixel>
+    render_scene(const Scene& scene, const Camera& camera, const RenderOptions& options = {}) noexcept;
+
+    /**
+    * \brief Render into a framebuffer of the given pixel type and record the features of every pixel for denoise_with_features()
+    *
+    * The features cost one extra primary ray per pixel, which is negligible unless very few samples per pixel are taken.
+    */
+    template <typename Pixel>
+    [[nodiscard]] std::pair<details::BasicFramebuffer<Pixel>, FeatureBuffer>
+    render_scene_with_features(const Scene& scene, const Camera& camera, const RenderOptions& options = {}) noexcept;
+
+    //Called from a render thread with the bounds [begin, end) of every finished tile
+    using RenderedTileCallback = std::function<void(Size2D begin, Size2D end)>;
+
+    /**
+    * \brief Render into output, which must have options.output_size, and report the tiles as they finish
+    *
+    * The image is split into tiles of tile_size (smaller at the right and bottom edges). All pixels of a tile are final when
+    * on_tile_rendered is called for it, so they can be processed while the rest of the image is still being rendered.
+    */
+    template <typename Pixel>
+    void render_scene(
+        details::BasicFramebuffer<Pixel>& output, const Scene& scene, const Camera& camera, const RenderOptions& options,
+        Size2D tile_size, const RenderedTileCallback& on_tile_rendered) noexcept;
+
 } // namespace Raychel
 
 #endif //!RAYCHEL_RENDERER_H
@@ -0,0 +1,176 @@
+/**
+* \file BVH.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for BoundingVolumeHierarchy class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/BVH.h"
+
+#include "RaychelCore/Raychel_assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace Raychel::details {
+
+    //Leaves with at most this many objects are not split any further
+    constexpr static std::uint32_t max_leaf_size{4U};
+
+    static double component(const vec3& v, std::size_t axis) noexcept
+    {
+        switch (axis) {
+            case 0U:
+                return v.x();
+            case 1U:
+                return v.y();
+            default:
+                return v.z();
+        }
+    }
+
+    static double centroid_along(const AABB& box, std::size_t axis) noexcept
+    {
+        const auto centroid = component(box.center(), axis);
+        //Unbounded objects would produce NaN centroids, which break the sorting below
+        if (!std::isfinite(centroid)) {
+            return 0.0;
+        }
+        return centroid;
+    }
+
+    BoundingVolumeHierarchy::BoundingVolumeHierarchy(const std::vector<AABB>& leaf_bounds) noexcept
+    {
+        if (leaf_bounds.empty()) {
+            return;
+        }
+        RAYCHEL_ASSERT(leaf_bounds.size() < std::numeric_limits<std::uint32_t>::max());
+
+        const auto leaf_count = static_cast<std::uint32_t>(leaf_bounds.size());
+
+        leaf_order_.resize(leaf_count);
+        std::iota(leaf_order_.begin(), leaf_order_.end(), 0U);
+
+        nodes_.reserve(2U * (leaf_count / max_leaf_size + 1U));
+        nodes_.emplace_back();
+        _build(0U, 0U, leaf_count, leaf_bounds);
+
+        ordered_leaf_bounds_.reserve(leaf_count);
+        for (const auto leaf : leaf_order_) {
+            ordered_leaf_bounds_.emplace_back(leaf_bounds[leaf]);
+        }
+    }
+
+    RayInterval BoundingVolumeHierarchy::clip_ray(const vec3& origin, const vec3& direction) const noexcept
+    {
+        auto result = RayInterval::empty();
+        if (nodes_.empty()) {
+            return result;
+        }
+
+        const auto misses = [](const RayInterval& interval) {
+            return interval.is_empty() || interval.exit < 0.0;
+        };
+
+        std::array<std::uint32_t, max_depth> stack{};
+        std::size_t stack_size{};
+        stack[stack_size++] = 0U;
+
+        while (stack_size != 0U) {
+            const auto& node = nodes_[stack[--stack_size]];
+
+            //The interval of every leaf lies inside the interval of its parent
+            const auto node_interval = intersect_ray(node.bounds, origin, direction);
+            if (misses(node_interval) || (node_interval.entry >= result.entry && node_interval.exit <= result.exit)) {
+                continue;
+            }
+
+            if (!node.is_leaf()) {
+                stack[stack_size++] = node.first;
+                stack[stack_size++] = node.first + 1U;
+                continue;
+            }
+
+            for (auto i = node.first; i != node.first + node.count; ++i) {
+                const auto interval = intersect_ray(ordered_leaf_bounds_[i], origin, direction);
+                if (misses(interval)) {
+                    continue;
+                }
+                result.entry = std::min(result.entry, interval.entry);
+                result.exit = std::max(result.exit, interval.exit);
+            }
+        }
+
+        return result;
+    }
+
+    void BoundingVolumeHierarchy::_build(
+        std::uint32_t node_index, std::uint32_t first, std::uint32_t count, const std::vector<AABB>& leaf_bounds)
+    {
+        const auto begin = leaf_order_.begin() + first;
+        const auto end = begin + count;
+
+        auto bounds = AABB::empty();
+        auto centroid_bounds = AABB::empty();
+        for (auto it = begin; it != end; ++it) {
+            const auto& leaf = leaf_bounds[*it];
+            bounds = merge(bounds, leaf);
+
+            const vec3 centroid{centroid_along(leaf, 0U), centroid_along(leaf, 1U), centroid_along(leaf, 2U)};
+            centroid_bounds = merge(centroid_bounds, AABB{centroid, centroid});
+        }
+        nodes_[node_index].bounds = bounds;
+
+        if (count <= max_leaf_size) {
+            nodes_[node_index].first = first;
+            nodes_[node_index].count = count;
+            return;
+        }
+
+        const auto extent = centroid_bounds.extent();
+        std::size_t axis{0U};
+        if (extent.y() > component(extent, axis)) {
+            axis = 1U;
+        }
+        if (extent.z() > component(extent, axis)) {
+            axis = 2U;
+        }
+
+        const auto half_count = count / 2U;
+        std::nth_element(begin, begin + half_count, end, [&](std::uint32_t a, std::uint32_t b) {
+            return centroid_along(leaf_bounds[a], axis) < centroid_along(leaf_bounds[b], axis);
+        });
+
+        const auto left_index = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+        nodes_.emplace_back();
+        nodes_[node_index].first = left_index;
+        nodes_[node_index].count = 0U;
+
+        _build(left_index, first, half_count, leaf_bounds);
+        _build(left_index + 1U, first + half_count, count - half_count, leaf_bounds);
+    }
+
+} // namespace Raychel::details
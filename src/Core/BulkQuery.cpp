@@ -0,0 +1,217 @@
+/**
+* \file BulkQuery.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for bulk distance field queries
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/BulkQuery.h"
+#include "Raychel/Core/CpuDispatch.h"
+#include "Raychel/Core/Raymarch.h"
+
+#include "RaychelCore/Raychel_assert.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+namespace Raychel {
+
+    //Number of points that are processed together. Large enough to amortize the per-surface overhead, small enough to stay in L1
+    constexpr static std::size_t chunk_size{256U};
+
+    struct PointChunk
+    {
+        std::size_t begin{};
+        std::size_t size{};
+
+        std::array<double, chunk_size> x{}, y{}, z{};
+
+        std::array<double, chunk_size> closest_distance{};
+        std::array<double, chunk_size> signed_distance{};
+        std::array<std::size_t, chunk_size> hit_index{};
+    };
+
+    template <typename F>
+    RAYCHEL_KERNEL_INLINE static void update_chunk(PointChunk& chunk, std::size_t hit_index, F&& distance_of) noexcept
+    {
+        //Points are the inner loop, so this vectorizes across points
+        for (std::size_t i{}; i != chunk.size; ++i) {
+            const auto distance = distance_of(chunk.x[i], chunk.y[i], chunk.z[i]);
+            const auto abs_distance = std::abs(distance);
+            const auto is_closer = (abs_distance < chunk.closest_distance[i]) ||
+                                   (abs_distance == chunk.closest_distance[i] && hit_index < chunk.hit_index[i]);
+
+            chunk.closest_distance[i] = is_closer ? abs_distance : chunk.closest_distance[i];
+            chunk.signed_distance[i] = is_closer ? distance : chunk.signed_distance[i];
+            chunk.hit_index[i] = is_closer ? hit_index : chunk.hit_index[i];
+        }
+    }
+
+    RAYCHEL_DISPATCH_KERNEL static void evaluate_spheres(const details::SphereGroup& group, PointChunk& chunk) noexcept
+    {
+        for (std::size_t i{}; i != group.size(); ++i) {
+            const auto center_x = group.center_x[i];
+            const auto center_y = group.center_y[i];
+            const auto center_z = group.center_z[i];
+            const auto radius = group.radius[i];
+
+            update_chunk(chunk, group.index_in_scene[i], [=](double x, double y, double z) {
+                return std::sqrt(sq(x - center_x) + sq(y - center_y) + sq(z - center_z)) - radius;
+            });
+        }
+    }
+
+    RAYCHEL_DISPATCH_KERNEL static void evaluate_boxes(const details::BoxGroup& group, PointChunk& chunk) noexcept
+    {
+        for (std::size_t i{}; i != group.size(); ++i) {
+            const auto center_x = group.center_x[i];
+            const auto center_y = group.center_y[i];
+            const auto center_z = group.center_z[i];
+            const auto size_x = group.size_x[i];
+            const auto size_y = group.size_y[i];
+            const auto size_z = group.size_z[i];
+
+            update_chunk(chunk, group.index_in_scene[i], [=](double x, double y, double z) {
+                using std::abs, std::max, std::min;
+                const auto qx = abs(x - center_x) - size_x;
+                const auto qy = abs(y - center_y) - size_y;
+                const auto qz = abs(z - center_z) - size_z;
+
+                const auto outside = std::sqrt(sq(max(qx, 0.0)) + sq(max(qy, 0.0)) + sq(max(qz, 0.0)));
+                return outside + min(max(qx, max(qy, qz)), 0.0);
+            });
+        }
+    }
+
+    static void evaluate_remaining_surfaces(const FrozenScene& scene, PointChunk& chunk) noexcept
+    {
+        const auto& surfaces = scene.surfaces();
+        for (const auto index : scene.remaining_surfaces()) {
+            update_chunk(chunk, index, [&surface = surfaces[index]](double x, double y, double z) {
+                return surface.evaluate(vec3{x, y, z}) / surface.lipschitz_constant();
+            });
+        }
+    }
+
+    static void write_chunk(
+        const FrozenScene& scene, const PointChunk& chunk, const BulkQueryOutput& output, const BulkQueryOptions& options) noexcept
+    {
+        std::copy_n(chunk.signed_distance.begin(), chunk.size, output.distances.begin() + static_cast<std::ptrdiff_t>(chunk.begin));
+
+        if (!output.hit_indices.empty()) {
+            std::copy_n(chunk.hit_index.begin(), chunk.size, output.hit_indices.begin() + static_cast<std::ptrdiff_t>(chunk.begin));
+        }
+
+        if (!output.gradients.empty()) {
+            for (std::size_t i{}; i != chunk.size; ++i) {
+                const auto hit_index = chunk.hit_index[i];
+                if (hit_index == no_hit) {
+                    output.gradients[chunk.begin + i] = vec3{};
+                    continue;
+                }
+                const vec3 point{chunk.x[i], chunk.y[i], chunk.z[i]};
+                output.gradients[chunk.begin + i] = get_normal(point, scene.surfaces()[hit_index], options.gradient_offset);
+            }
+        }
+    }
+
+    template <typename LoadPoints>
+    static void evaluate_bulk(
+        const FrozenScene& scene, std::size_t point_count, LoadPoints&& load_points, const BulkQueryOutput& output,
+        const BulkQueryOptions& options) noexcept
+    {
+        RAYCHEL_ASSERT(output.distances.size() >= point_count);
+        RAYCHEL_ASSERT(output.hit_indices.empty() || output.hit_indices.size() >= point_count);
+        RAYCHEL_ASSERT(output.gradients.empty() || output.gradients.size() >= point_count);
+
+        const auto evaluate_chunk = [&](std::size_t chunk_index) {
+            PointChunk chunk{};
+            chunk.begin = chunk_index * chunk_size;
+            chunk.size = std::min(chunk_size, point_count - chunk.begin);
+
+            load_points(chunk);
+            chunk.closest_distance.fill(1e9);
+            chunk.signed_distance.fill(1e9);
+            chunk.hit_index.fill(no_hit);
+
+            evaluate_spheres(scene.spheres(), chunk);
+            evaluate_boxes(scene.boxes(), chunk);
+            evaluate_remaining_surfaces(scene, chunk);
+
+            write_chunk(scene, chunk, output, options);
+        };
+
+        const auto chunk_count = (point_count + chunk_size - 1U) / chunk_size;
+        if (!options.parallel || chunk_count == 1U) {
+            for (std::size_t i{}; i != chunk_count; ++i) {
+                evaluate_chunk(i);
+            }
+            return;
+        }
+
+        std::vector<std::size_t> chunk_indices(chunk_count);
+        std::iota(chunk_indices.begin(), chunk_indices.end(), 0U);
+        std::for_each(std::execution::par, chunk_indices.begin(), chunk_indices.end(), evaluate_chunk);
+    }
+
+    void evaluate_distance_field(
+        const FrozenScene& scene, std::span<const vec3> points, BulkQueryOutput output, BulkQueryOptions options) noexcept
+    {
+        evaluate_bulk(
+            scene,
+            points.size(),
+            [points](PointChunk& chunk) {
+                for (std::size_t i{}; i != chunk.size; ++i) {
+                    const auto& point = points[chunk.begin + i];
+                    chunk.x[i] = point.x();
+                    chunk.y[i] = point.y();
+                    chunk.z[i] = point.z();
+                }
+            },
+            output,
+            options);
+    }
+
+    void evaluate_distance_field(const FrozenScene& scene, PointsSoA points, BulkQueryOutput output, BulkQueryOptions options) noexcept
+    {
+        RAYCHEL_ASSERT(points.y.size() == points.size() && points.z.size() == points.size());
+
+        evaluate_bulk(
+            scene,
+            points.size(),
+            [points](PointChunk& chunk) {
+                const auto begin = static_cast<std::ptrdiff_t>(chunk.begin);
+                std::copy_n(points.x.begin() + begin, chunk.size, chunk.x.begin());
+                std::copy_n(points.y.begin() + begin, chunk.size, chunk.y.begin());
+                std::copy_n(points.z.begin() + begin, chunk.size, chunk.z.begin());
+            },
+            output,
+            options);
+    }
+
+} //namespace Raychel
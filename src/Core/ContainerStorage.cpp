@@ -0,0 +1,55 @@
+/**
+* \file ContainerStorage.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for ContainerArena class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/ContainerStorage.h"
+
+#include <algorithm>
+
+namespace Raychel::details {
+
+    void* ContainerArena::allocate(std::size_t size, std::size_t alignment) noexcept
+    {
+        RAYCHEL_ASSERT(alignment != 0U && (alignment & (alignment - 1U)) == 0U);
+        RAYCHEL_ASSERT(alignment <= alignof(std::max_align_t));
+
+        const auto aligned_offset = (current_offset_ + alignment - 1U) & ~(alignment - 1U);
+        if (blocks_.empty() || aligned_offset + size > current_block_size_) {
+            //operator new[] returns memory aligned for any fundamental type, so offset 0 is always suitably aligned
+            current_block_size_ = std::max(block_size, size);
+            blocks_.emplace_back(new std::byte[current_block_size_]);
+            current_offset_ = size;
+            bytes_used_ += size;
+            return blocks_.back().get();
+        }
+
+        current_offset_ = aligned_offset + size;
+        bytes_used_ += size;
+        return blocks_.back().get() + aligned_offset;
+    }
+
+} // namespace Raychel::details
@@ -0,0 +1,135 @@
+/**
+* \file DistanceGrid.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for the scene distance lower bound grid
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#include "Raychel/Core/DistanceGrid.h"
+#include "Raychel/Core/BulkQuery.h"
+#include "Raychel/Core/FrozenScene.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Raychel {
+
+    static std::size_t cells_along(double extent, double cell_size) noexcept
+    {
+        return std::max(std::size_t{1}, static_cast<std::size_t>(std::ceil(extent / cell_size)));
+    }
+
+    static float round_towards_zero(double distance) noexcept
+    {
+        const auto rounded = static_cast<float>(distance);
+        if (static_cast<double>(rounded) > distance) {
+            return std::nextafter(rounded, 0.0F);
+        }
+        return rounded;
+    }
+
+    DistanceGrid::DistanceGrid(const FrozenScene& scene, const DistanceGridOptions& options) noexcept
+    {
+        if (options.resolution == 0U) {
+            return;
+        }
+
+        auto scene_bounds = AABB::empty();
+        is_scene_bounded_ = true;
+        for (const auto& bounds : scene.surface_bounds()) {
+            if (bounds.is_finite()) {
+                scene_bounds = merge(scene_bounds, bounds);
+            } else {
+                is_scene_bounded_ = false;
+            }
+        }
+
+        if (scene_bounds.is_empty()) {
+            return;
+        }
+
+        const auto extent = scene_bounds.extent();
+        const auto longest_side = std::max({extent.x(), extent.y(), extent.z()});
+        if (!(longest_side > 0.0)) {
+            return;
+        }
+
+        cell_size_ = longest_side / static_cast<double>(options.resolution);
+        cell_count_ = {
+            cells_along(extent.x(), cell_size_), cells_along(extent.y(), cell_size_), cells_along(extent.z(), cell_size_)};
+        bounds_ = AABB{
+            scene_bounds.lower,
+            scene_bounds.lower + vec3{
+                                     static_cast<double>(cell_count_[0]) * cell_size_,
+                                     static_cast<double>(cell_count_[1]) * cell_size_,
+                                     static_cast<double>(cell_count_[2]) * cell_size_}};
+
+        std::vector<vec3> cell_centers{};
+        cell_centers.reserve(cell_count_[0] * cell_count_[1] * cell_count_[2]);
+        for (std::size_t z{}; z != cell_count_[2]; ++z) {
+            for (std::size_t y{}; y != cell_count_[1]; ++y) {
+                for (std::size_t x{}; x != cell_count_[0]; ++x) {
+                    const vec3 cell{static_cast<double>(x) + 0.5, static_cast<double>(y) + 0.5, static_cast<double>(z) + 0.5};
+                    cell_centers.emplace_back(bounds_.lower + cell * cell_size_);
+                }
+            }
+        }
+
+        std::vector<double> distances(cell_centers.size());
+        evaluate_distance_field(scene, std::span<const vec3>{cell_centers}, BulkQueryOutput{.distances = distances});
+
+        center_distances_.reserve(distances.size());
+        for (const auto distance : distances) {
+            center_distances_.emplace_back(round_towards_zero(std::abs(distance)));
+        }
+    }
+
+    double DistanceGrid::lower_bound(const vec3& p) const noexcept
+    {
+        if (empty()) {
+            return 0.0;
+        }
+
+        const auto outside_distance = distance_to_bounds(bounds_, p);
+        if (outside_distance > 0.0) {
+            return is_scene_bounded_ ? outside_distance : 0.0;
+        }
+
+        const auto cell_index = [this](double coordinate, std::size_t axis) {
+            const auto index = static_cast<std::size_t>(std::max(coordinate / cell_size_, 0.0));
+            return std::min(index, cell_count_[axis] - 1U);
+        };
+
+        const auto local = p - bounds_.lower;
+        const auto x = cell_index(local.x(), 0U);
+        const auto y = cell_index(local.y(), 1U);
+        const auto z = cell_index(local.z(), 2U);
+
+        const vec3 cell{static_cast<double>(x) + 0.5, static_cast<double>(y) + 0.5, static_cast<double>(z) + 0.5};
+        const auto center = bounds_.lower + cell * cell_size_;
+
+        const auto center_distance = static_cast<double>(center_distances_[(z * cell_count_[1] + y) * cell_count_[0] + x]);
+        return std::max(center_distance - mag(p - center), 0.0);
+    }
+
+} //namespace Raychel
@@ -0,0 +1,326 @@
+/**
+* \file FrozenScene.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for FrozenScene class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/FrozenScene.h"
+#include "Raychel/Core/CpuDispatch.h"
+#include "Raychel/Core/Raymarch.h"
+#include "Raychel/Core/SDFTransforms.h"
+#include "Raychel/Core/Serialize.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Raychel {
+
+    //Number of independent minimums tracked while scanning a group. Keeping them separate allows the compiler to vectorize the scan.
+    //This fills one 512 bit register, so single precision groups get twice as many lanes
+    template <typename T>
+    constexpr static std::size_t lane_count{64U / sizeof(T)};
+
+    template <typename T>
+    struct ClosestSurface
+    {
+        T distance{1e9};
+        std::size_t hit_index{no_hit};
+    };
+
+    static void add_sphere(details::SphereGroup& group, const vec3& center, const Sphere& sphere, std::size_t index) noexcept
+    {
+        group.center_x.emplace_back(center.x());
+        group.center_y.emplace_back(center.y());
+        group.center_z.emplace_back(center.z());
+        group.radius.emplace_back(sphere.radius);
+        group.index_in_scene.emplace_back(index);
+    }
+
+    static void add_box(details::BoxGroup& group, const vec3& center, const Box& box, std::size_t index) noexcept
+    {
+        group.center_x.emplace_back(center.x());
+        group.center_y.emplace_back(center.y());
+        group.center_z.emplace_back(center.z());
+        group.size_x.emplace_back(box.size.x());
+        group.size_y.emplace_back(box.size.y());
+        group.size_z.emplace_back(box.size.z());
+        group.index_in_scene.emplace_back(index);
+    }
+
+    static bool try_add_to_group(
+        const SDFContainer& surface, const vec3& translation, std::size_t index, details::SphereGroup& spheres,
+        details::BoxGroup& boxes) noexcept
+    {
+        const auto type_id = surface.type_id();
+
+        if (type_id == details::TypeId<Sphere>::id()) {
+            add_sphere(spheres, translation, details::get_container_content<Sphere>(surface), index);
+            return true;
+        }
+        if (type_id == details::TypeId<Box>::id()) {
+            add_box(boxes, translation, details::get_container_content<Box>(surface), index);
+            return true;
+        }
+        if (type_id == details::TypeId<Translate<Sphere>>::id()) {
+            const auto& object = details::get_container_content<Translate<Sphere>>(surface);
+            add_sphere(spheres, translation + object.translation, object.target, index);
+            return true;
+        }
+        if (type_id == details::TypeId<Translate<Box>>::id()) {
+            const auto& object = details::get_container_content<Translate<Box>>(surface);
+            add_box(boxes, translation + object.translation, object.target, index);
+            return true;
+        }
+        //Deserialized scenes only contain type-erased targets
+        if (type_id == details::TypeId<Translate<SDFContainer>>::id()) {
+            const auto& object = details::get_container_content<Translate<SDFContainer>>(surface);
+            return try_add_to_group(object.target, translation + object.translation, index, spheres, boxes);
+        }
+        return false;
+    }
+
+    //Copy the entries that were added to group since the last call into its single precision counterpart
+    static void update_float_group(
+        const details::SphereGroup& group, details::BasicSphereGroup<float>& float_group, double& magnitude) noexcept
+    {
+        for (auto i = float_group.size(); i != group.size(); ++i) {
+            float_group.center_x.emplace_back(static_cast<float>(group.center_x[i]));
+            float_group.center_y.emplace_back(static_cast<float>(group.center_y[i]));
+            float_group.center_z.emplace_back(static_cast<float>(group.center_z[i]));
+            float_group.radius.emplace_back(static_cast<float>(group.radius[i]));
+            float_group.index_in_scene.emplace_back(group.index_in_scene[i]);
+
+            const auto center_magnitude = std::max({std::abs(group.center_x[i]), std::abs(group.center_y[i]), std::abs(group.center_z[i])});
+            magnitude = std::max(magnitude, center_magnitude + group.radius[i]);
+        }
+    }
+
+    static void
+    update_float_group(const details::BoxGroup& group, details::BasicBoxGroup<float>& float_group, double& magnitude) noexcept
+    {
+        for (auto i = float_group.size(); i != group.size(); ++i) {
+            float_group.center_x.emplace_back(static_cast<float>(group.center_x[i]));
+            float_group.center_y.emplace_back(static_cast<float>(group.center_y[i]));
+            float_group.center_z.emplace_back(static_cast<float>(group.center_z[i]));
+            float_group.size_x.emplace_back(static_cast<float>(group.size_x[i]));
+            float_group.size_y.emplace_back(static_cast<float>(group.size_y[i]));
+            float_group.size_z.emplace_back(static_cast<float>(group.size_z[i]));
+            float_group.index_in_scene.emplace_back(group.index_in_scene[i]);
+
+            const auto center_magnitude = std::max({std::abs(group.center_x[i]), std::abs(group.center_y[i]), std::abs(group.center_z[i])});
+            const auto size_magnitude = std::max({group.size_x[i], group.size_y[i], group.size_z[i]});
+            magnitude = std::max(magnitude, center_magnitude + size_magnitude);
+        }
+    }
+
+    FrozenScene::FrozenScene(const std::vector<SDFContainer>& surfaces) noexcept : surfaces_{&surfaces}
+    {
+        surface_bounds_.reserve(surfaces.size());
+        for (std::size_t i{}; i != surfaces.size(); ++i) {
+            _add_surface(i);
+        }
+        bounds_hierarchy_ = details::BoundingVolumeHierarchy{surface_bounds_};
+    }
+
+    FrozenScene::FrozenScene(const std::vector<SDFContainer>& surfaces, std::span<const std::size_t> subset) noexcept
+        : surfaces_{&surfaces}
+    {
+        RAYCHEL_ASSERT(std::is_sorted(subset.begin(), subset.end()));
+
+        surface_bounds_.reserve(subset.size());
+        for (const auto index : subset) {
+            _add_surface(index);
+        }
+        bounds_hierarchy_ = details::BoundingVolumeHierarchy{surface_bounds_};
+    }
+
+    void FrozenScene::_add_surface(std::size_t index) noexcept
+    {
+        const auto& surface = (*surfaces_)[index];
+
+        surface_bounds_.emplace_back(surface.bounds());
+        bounds_ = merge(bounds_, surface_bounds_.back());
+
+        if (!try_add_to_group(surface, vec3{}, index, spheres_, boxes_)) {
+            remaining_surfaces_.emplace_back(index);
+            return;
+        }
+        update_float_group(spheres_, spheres_float_, float_group_magnitude_);
+        update_float_group(boxes_, boxes_float_, float_group_magnitude_);
+    }
+
+    FrozenScene::FrozenScene(const std::vector<SDFContainer>& surfaces, const DistanceGridOptions& grid_options) noexcept
+        : FrozenScene{surfaces}
+    {
+        distance_grid_ = DistanceGrid{*this, grid_options};
+    }
+
+    RayInterval FrozenScene::clip_ray(const vec3& origin, const vec3& direction) const noexcept
+    {
+        const auto scene_interval = intersect_ray(bounds_, origin, direction);
+        if (scene_interval.is_empty() || scene_interval.exit < 0.0) {
+            return RayInterval::empty();
+        }
+
+        //The ray might still pass between all surfaces, so narrow the interval down using the individual bounds
+        return bounds_hierarchy_.clip_ray(origin, direction);
+    }
+
+    template <typename T, typename F>
+    RAYCHEL_KERNEL_INLINE static void update_closest_in_group(
+        std::size_t group_size, F&& distance_of, const std::vector<std::size_t>& index_in_scene, ClosestSurface<T>& closest) noexcept
+    {
+        constexpr auto lane_count = Raychel::lane_count<T>;
+
+        //Indices as wide as the distances, so comparing distances gives a mask that can select indices directly
+        using LaneIndex = std::conditional_t<sizeof(T) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>;
+        constexpr auto no_lane_index = std::numeric_limits<LaneIndex>::max();
+        RAYCHEL_ASSERT(group_size < no_lane_index);
+
+        std::array<T, lane_count> lane_distance{};
+        std::array<LaneIndex, lane_count> lane_index{};
+        lane_distance.fill(closest.distance);
+        lane_index.fill(no_lane_index);
+
+        LaneIndex i{};
+        for (; i + lane_count <= group_size; i += lane_count) {
+            for (LaneIndex lane{}; lane != lane_count; ++lane) {
+                const auto distance = distance_of(i + lane);
+                const auto is_closer = distance < lane_distance[lane];
+                lane_distance[lane] = is_closer ? distance : lane_distance[lane];
+                lane_index[lane] = is_closer ? (i + lane) : lane_index[lane];
+            }
+        }
+        for (; i != group_size; ++i) {
+            const auto distance = distance_of(i);
+            if (distance < lane_distance[0]) {
+                lane_distance[0] = distance;
+                lane_index[0] = i;
+            }
+        }
+
+        //Ties are broken by scene index so the result does not depend on how the surfaces are grouped
+        for (std::size_t lane{}; lane != lane_count; ++lane) {
+            if (lane_index[lane] == no_lane_index) {
+                continue;
+            }
+            const auto hit_index = index_in_scene[lane_index[lane]];
+            if (lane_distance[lane] < closest.distance ||
+                (lane_distance[lane] == closest.distance && hit_index < closest.hit_index)) {
+                closest = {lane_distance[lane], hit_index};
+            }
+        }
+    }
+
+    template <typename T>
+    RAYCHEL_KERNEL_INLINE static void update_closest_sphere(
+        const details::BasicSphereGroup<T>& group, const basic_vec3<T>& p, ClosestSurface<T>& closest) noexcept
+    {
+        const auto* const x = group.center_x.data();
+        const auto* const y = group.center_y.data();
+        const auto* const z = group.center_z.data();
+        const auto* const radius = group.radius.data();
+
+        update_closest_in_group(
+            group.size(),
+            [=](std::size_t i) {
+                const auto distance_to_center = std::sqrt(sq(p.x() - x[i]) + sq(p.y() - y[i]) + sq(p.z() - z[i]));
+                return std::abs(distance_to_center - radius[i]);
+            },
+            group.index_in_scene,
+            closest);
+    }
+
+    template <typename T>
+    RAYCHEL_KERNEL_INLINE static void
+    update_closest_box(const details::BasicBoxGroup<T>& group, const basic_vec3<T>& p, ClosestSurface<T>& closest) noexcept
+    {
+        const auto* const x = group.center_x.data();
+        const auto* const y = group.center_y.data();
+        const auto* const z = group.center_z.data();
+        const auto* const size_x = group.size_x.data();
+        const auto* const size_y = group.size_y.data();
+        const auto* const size_z = group.size_z.data();
+
+        update_closest_in_group(
+            group.size(),
+            [=](std::size_t i) {
+                using std::abs, std::max, std::min;
+                const auto qx = abs(p.x() - x[i]) - size_x[i];
+                const auto qy = abs(p.y() - y[i]) - size_y[i];
+                const auto qz = abs(p.z() - z[i]) - size_z[i];
+
+                const auto outside = std::sqrt(sq(max(qx, T{0})) + sq(max(qy, T{0})) + sq(max(qz, T{0})));
+                const auto inside = min(max(qx, max(qy, qz)), T{0});
+                return abs(outside + inside);
+            },
+            group.index_in_scene,
+            closest);
+    }
+
+    RAYCHEL_DISPATCH_KERNEL std::pair<double, std::size_t> evaluate_distance_field(const FrozenScene& scene, const vec3& point) noexcept
+    {
+        ClosestSurface<double> closest{};
+
+        update_closest_sphere(scene.spheres(), point, closest);
+        update_closest_box(scene.boxes(), point, closest);
+
+        const auto& surfaces = scene.surfaces();
+        for (const auto i : scene.remaining_surfaces()) {
+            const auto surface_distance = std::abs(surfaces[i].evaluate(point)) / surfaces[i].lipschitz_constant();
+
+            if (surface_distance < closest.distance || (surface_distance == closest.distance && i < closest.hit_index)) {
+                closest = {surface_distance, i};
+            }
+        }
+
+        return {closest.distance, closest.hit_index};
+    }
+
+    RAYCHEL_DISPATCH_KERNEL std::pair<float, std::size_t>
+    evaluate_distance_field(const FrozenScene& scene, const basic_vec3<float>& point) noexcept
+    {
+        ClosestSurface<float> closest{};
+
+        update_closest_sphere(scene.spheres_float(), point, closest);
+        update_closest_box(scene.boxes_float(), point, closest);
+
+        //Surfaces behind an SDFContainer only exist in double precision
+        const auto& surfaces = scene.surfaces();
+        const vec3 double_point{point.x(), point.y(), point.z()};
+        for (const auto i : scene.remaining_surfaces()) {
+            const auto surface_distance =
+                static_cast<float>(std::abs(surfaces[i].evaluate(double_point)) / surfaces[i].lipschitz_constant());
+
+            if (surface_distance < closest.distance || (surface_distance == closest.distance && i < closest.hit_index)) {
+                closest = {surface_distance, i};
+            }
+        }
+
+        return {closest.distance, closest.hit_index};
+    }
+
+} //namespace Raychel
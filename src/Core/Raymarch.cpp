@@ -27,8 +27,14 @@
 */
 
 #include "Raychel/Core/Raymarch.h"
+#include "Raychel/Core/FrozenScene.h"
 #include "Raychel/Core/SDFContainer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
 namespace Raychel {
 
     std::pair<double, std::size_t> evaluate_distance_field(const std::vector<SDFContainer>& surfaces, const vec3& point) noexcept
@@ -38,7 +44,7 @@ namespace Raychel {
         double min_distance{1e9};
         auto hit_index = no_hit;
         for (std::size_t i{}; i != surfaces_size; ++i) {
-            const auto surface_distance = std::abs(surfaces[i].evaluate(point));
+            const auto surface_distance = std::abs(surfaces[i].evaluate(point)) / surfaces[i].lipschitz_constant();
 
             if (surface_distance < min_distance) {
                 hit_index = i;
@@ -48,16 +54,91 @@ namespace Raychel {
         return {min_distance, hit_index};
     }
 
-    RaymarchResult raymarch(
-        vec3 current_point, const vec3& direction, const std::vector<SDFContainer>& surfaces, RaymarchOptions options) noexcept
+    //Bound on the rounding error of the single precision distance field, ignoring the error of the distance itself
+    static double get_float_error_bound(const FrozenScene& scene, const vec3& point) noexcept
+    {
+        constexpr auto float_epsilon = static_cast<double>(std::numeric_limits<float>::epsilon());
+
+        const auto magnitude =
+            std::max({std::abs(point.x()), std::abs(point.y()), std::abs(point.z())}) + scene.float_group_magnitude();
+        return 4.0 * float_epsilon * magnitude;
+    }
+
+    //Below this distance, the error bound would eat too much of each step and the ray has to be marched in double precision
+    static double get_min_float_distance(const FrozenScene& scene, const vec3& point, const RaymarchOptions& options) noexcept
+    {
+        return 32.0 * std::max(get_float_error_bound(scene, point), options.surface_epsilon);
+    }
+
+    template <typename Surfaces>
+    static RaymarchResult
+    raymarch_internal(vec3 current_point, const vec3& direction, const Surfaces& surfaces, RaymarchOptions options) noexcept
     {
         double depth{};
+        auto max_depth = options.max_ray_depth;
         std::size_t step{};
-        while (step != options.max_ray_steps && depth < options.max_ray_depth) {
+
+        //Whether the next step is taken in single precision. Only possible for FrozenScenes
+        [[maybe_unused]] auto use_float = options.mixed_precision;
+
+        if constexpr (std::is_same_v<Surfaces, FrozenScene>) {
+            //Surfaces can only be hit between entering and leaving their bounds
+            const auto interval = surfaces.clip_ray(current_point, direction);
+            if (interval.is_empty() || interval.exit < 0.0 || interval.entry > max_depth) {
+                return {current_point, depth, step, no_hit};
+            }
+            if (interval.entry > 0.0) {
+                current_point += direction * interval.entry;
+                depth = interval.entry;
+            }
+            max_depth = std::min(max_depth, interval.exit + options.surface_epsilon);
+        }
+
+        while (step != options.max_ray_steps && depth < max_depth) {
+            if constexpr (std::is_same_v<Surfaces, FrozenScene>) {
+                //Only skip if the step is worth it, small bounds are usually much smaller than the actual distance
+                const auto& grid = surfaces.distance_grid();
+                const auto lower_bound = grid.lower_bound(current_point);
+                if (lower_bound > 0.0 && lower_bound >= grid.cell_size() && lower_bound >= options.surface_epsilon) {
+                    current_point += direction * lower_bound;
+                    depth += lower_bound;
+                    ++step;
+                    continue;
+                }
+
+                //Far away from all surfaces, the single precision distance is good enough once it is shortened by its error bound
+                if (use_float) {
+                    const basic_vec3<float> float_point{
+                        static_cast<float>(current_point.x()),
+                        static_cast<float>(current_point.y()),
+                        static_cast<float>(current_point.z())};
+                    const auto distance = static_cast<double>(evaluate_distance_field(surfaces, float_point).first);
+
+                    if (distance >= get_min_float_distance(surfaces, current_point, options)) {
+                        constexpr auto float_epsilon = static_cast<double>(std::numeric_limits<float>::epsilon());
+                        const auto safe_distance =
+                            distance - get_float_error_bound(surfaces, current_point) - float_epsilon * distance;
+
+                        current_point += direction * safe_distance;
+                        depth += safe_distance;
+                        ++step;
+                        continue;
+                    }
+                    use_float = false;
+                }
+            }
+
             const auto [max_distance, hit_index] = evaluate_distance_field(surfaces, current_point);
             if (max_distance < options.surface_epsilon) {
                 return {current_point, depth, step, hit_index};
             }
+
+            if constexpr (std::is_same_v<Surfaces, FrozenScene>) {
+                //Switch back only with some margin, so rays that graze a surface do not evaluate both precisions every step
+                use_float = options.mixed_precision &&
+                            max_distance >= 2.0 * get_min_float_distance(surfaces, current_point, options);
+            }
+
             current_point += direction * max_distance;
             depth += max_distance;
             ++step;
@@ -65,6 +146,17 @@ namespace Raychel {
         return {current_point, depth, step, no_hit};
     }
 
+    RaymarchResult raymarch(
+        vec3 current_point, const vec3& direction, const std::vector<SDFContainer>& surfaces, RaymarchOptions options) noexcept
+    {
+        return raymarch_internal(current_point, direction, surfaces, options);
+    }
+
+    RaymarchResult raymarch(vec3 current_point, const vec3& direction, const FrozenScene& scene, RaymarchOptions options) noexcept
+    {
+        return raymarch_internal(current_point, direction, scene, options);
+    }
+
     vec3 get_normal(const vec3& point, const SDFContainer& surface, double normal_offset) noexcept
     {
         //This implements the tetrahedon sampling technique found at https://iquilezles.org/articles/normalsSDF/
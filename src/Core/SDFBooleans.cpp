@@ -0,0 +1,76 @@
+/**
+* \file SDFBooleans.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for boolean SDF operations
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#include "Raychel/Core/SDFBooleans.h"
+
+namespace Raychel {
+
+    UnionN::UnionN(std::vector<SDFContainer> targets) noexcept : targets_{std::move(targets)}
+    {
+        std::vector<AABB> target_bounds{};
+        target_bounds.reserve(targets_.size());
+
+        for (std::size_t i{}; i != targets_.size(); ++i) {
+            const auto bounds = targets_[i].bounds();
+            bounds_ = merge(bounds_, bounds);
+            lipschitz_constant_ = std::max(lipschitz_constant_, targets_[i].lipschitz_constant());
+
+            if (bounds.is_finite()) {
+                bounded_targets_.emplace_back(i);
+                target_bounds.emplace_back(bounds);
+            } else {
+                unbounded_targets_.emplace_back(i);
+            }
+        }
+
+        hierarchy_ = details::BoundingVolumeHierarchy{target_bounds};
+    }
+
+    std::pair<double, std::size_t> UnionN::closest_target(const vec3& p) const noexcept
+    {
+        double closest_distance{1e9};
+        std::size_t closest_index{targets_.size()};
+
+        //Unbounded targets cannot be skipped, but they give the hierarchy a head start
+        for (const auto index : unbounded_targets_) {
+            const auto distance = targets_[index].evaluate(p);
+            if (distance < closest_distance) {
+                closest_distance = distance;
+                closest_index = index;
+            }
+        }
+
+        const auto [distance, leaf] = hierarchy_.closest(
+            p, [&](std::size_t leaf_index) { return targets_[bounded_targets_[leaf_index]].evaluate(p); }, closest_distance);
+        if (leaf < bounded_targets_.size()) {
+            return {distance, bounded_targets_[leaf]};
+        }
+
+        return {closest_distance, closest_index};
+    }
+
+} //namespace Raychel
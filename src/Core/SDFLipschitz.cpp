@@ -0,0 +1,117 @@
+/**
+* \file SDFLipschitz.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for Lipschitz constant validation
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/SDFLipschitz.h"
+#include "Raychel/Core/SDFContainer.h"
+#include "Raychel/Core/Xoroshiro128+.h"
+
+#include "RaychelLogger/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Raychel {
+
+    static AABB get_sample_region(const SDFContainer& surface, const LipschitzValidationOptions& options) noexcept
+    {
+        const auto bounds = surface.bounds();
+        if (!bounds.is_finite()) {
+            return options.unbounded_region;
+        }
+        //The field outside the bounds matters just as much, rays approach the surface from there
+        return expand(bounds, std::max(options.max_pair_distance, 0.25 * mag(bounds.upper - bounds.lower)));
+    }
+
+    LipschitzValidationResult validate_lipschitz(const SDFContainer& surface, const LipschitzValidationOptions& options) noexcept
+    {
+        LipschitzValidationResult result{.declared_constant = surface.lipschitz_constant()};
+
+        const auto region = get_sample_region(surface, options);
+        if (region.is_empty() || !region.is_finite()) {
+            return result;
+        }
+
+        Xoroshiro128 rng{options.seed};
+        std::uniform_real_distribution<double> x{region.lower.x(), region.upper.x()};
+        std::uniform_real_distribution<double> y{region.lower.y(), region.upper.y()};
+        std::uniform_real_distribution<double> z{region.lower.z(), region.upper.z()};
+        std::uniform_real_distribution<double> offset{-1.0, 1.0};
+        std::uniform_real_distribution<double> pair_distance{0.0, options.max_pair_distance};
+
+        const auto max_allowed = result.declared_constant * (1.0 + options.tolerance);
+        for (std::size_t i{}; i != options.sample_count; ++i) {
+            const vec3 a{x(rng), y(rng), z(rng)};
+
+            const vec3 direction{offset(rng), offset(rng), offset(rng)};
+            const auto length = mag(direction);
+            if (length == 0.0) {
+                continue;
+            }
+            const auto distance = pair_distance(rng);
+            if (distance == 0.0) {
+                continue;
+            }
+            const auto b = a + direction * (distance / length);
+
+            const auto constant = std::abs(surface.evaluate(a) - surface.evaluate(b)) / distance;
+            result.observed_constant = std::max(result.observed_constant, constant);
+            if (constant > max_allowed) {
+                ++result.violation_count;
+            }
+        }
+
+        return result;
+    }
+
+    std::size_t validate_lipschitz(const std::vector<SDFContainer>& surfaces, const LipschitzValidationOptions& options) noexcept
+    {
+        std::size_t invalid_surfaces{};
+        for (std::size_t i{}; i != surfaces.size(); ++i) {
+            const auto result = validate_lipschitz(surfaces[i], options);
+            if (result.is_valid()) {
+                continue;
+            }
+            Logger::warn(
+                "Surface ",
+                i,
+                " declares a Lipschitz constant of ",
+                result.declared_constant,
+                " but changes by up to ",
+                result.observed_constant,
+                " (",
+                result.violation_count,
+                '/',
+                options.sample_count,
+                " samples violate the constant)\n");
+            ++invalid_surfaces;
+        }
+        return invalid_surfaces;
+    }
+
+} //namespace Raychel
@@ -0,0 +1,99 @@
+/**
+* \file SDFTransforms.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for SDF transforms
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+#include "Raychel/Core/SDFTransforms.h"
+#include "Raychel/Core/Serialize.h"
+
+namespace Raychel {
+
+    static AffineTransform transform_of(const Translate<>& object) noexcept
+    {
+        return from_translation(object.translation);
+    }
+
+    static AffineTransform transform_of(const Rotate<>& object) noexcept
+    {
+        return from_rotation(object.rotation);
+    }
+
+    static AffineTransform transform_of(const Scale<>& object) noexcept
+    {
+        return from_scale(object.factor);
+    }
+
+    static AffineTransform transform_of(const Transformed<>& object) noexcept
+    {
+        return object.to_world();
+    }
+
+    template <typename T>
+    static bool try_unwrap(SDFContainer& object, AffineTransform& to_world) noexcept
+    {
+        if (object.type_id() != details::TypeId<T>::id()) {
+            return false;
+        }
+
+        auto& transform = details::get_container_content<T>(object);
+
+        //The transform applied last is the outermost one
+        to_world = compose(to_world, transform_of(transform));
+
+        //The target lives inside object, so it has to be moved out before object is overwritten
+        SDFContainer target{std::move(transform.target)};
+        object = std::move(target);
+
+        return true;
+    }
+
+    SDFContainer collapse_transforms(SDFContainer object) noexcept
+    {
+        AffineTransform to_world{};
+        std::size_t translation_count{};
+        std::size_t other_count{};
+
+        while (true) {
+            if (try_unwrap<Translate<>>(object, to_world)) {
+                ++translation_count;
+            } else if (
+                try_unwrap<Rotate<>>(object, to_world) || try_unwrap<Scale<>>(object, to_world) ||
+                try_unwrap<Transformed<>>(object, to_world)) {
+                ++other_count;
+            } else {
+                break;
+            }
+        }
+
+        if (translation_count + other_count == 0U) {
+            return object;
+        }
+        if (other_count == 0U) {
+            return SDFContainer{Translate<>{std::move(object), to_world.translation}};
+        }
+        return SDFContainer{Transformed<>{std::move(object), to_world}};
+    }
+
+} //namespace Raychel
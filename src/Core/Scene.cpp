@@ -27,9 +27,88 @@
 */
 
 #include "Raychel/Core/Scene.h"
+#include "Raychel/Core/SDFTransforms.h"
+
+#include <numeric>
 
 namespace Raychel {
 
+    template <typename T>
+    static void apply_order(std::vector<T>& values, const std::vector<std::size_t>& order) noexcept
+    {
+        std::vector<T> result{};
+        result.reserve(values.size());
+        for (const auto index : order) {
+            result.emplace_back(std::move(values.at(index)));
+        }
+        values = std::move(result);
+    }
+
+    Scene& Scene::operator=(Scene&& other) noexcept
+    {
+        if (this != &other) {
+            //The containers might live in our arena, so they have to go first
+            objects_.clear();
+            materials_.clear();
+
+            object_serializers_ = std::move(other.object_serializers_);
+            material_serializers_ = std::move(other.material_serializers_);
+            arena_ = std::move(other.arena_);
+            objects_ = std::move(other.objects_);
+            materials_ = std::move(other.materials_);
+            background_function_ = std::move(other.background_function_);
+        }
+        return *this;
+    }
+
+    void Scene::compact_storage() noexcept
+    {
+        //Containers in the old arena are moved out before it is destroyed
+        auto arena = std::make_unique<details::ContainerArena>();
+
+        for (auto& object : objects_) {
+            object.move_into(*arena);
+        }
+        for (auto& material : materials_) {
+            material.move_into(*arena);
+        }
+
+        arena_ = std::move(arena);
+    }
+
+    void Scene::collapse_transforms() noexcept
+    {
+        for (std::size_t i{}; i != objects_.size(); ++i) {
+            const auto old_type_id = objects_.at(i).type_id();
+            objects_.at(i) = Raychel::collapse_transforms(std::move(objects_.at(i)));
+
+            const auto new_type_id = objects_.at(i).type_id();
+            if (new_type_id == old_type_id) {
+                continue;
+            }
+            if (new_type_id == details::TypeId<Transformed<>>::id()) {
+                object_serializers_.at(i) =
+                    SerializableObjectData<SDFContainer>{details::SerializableObjectDescriptor<Transformed<>>{}};
+            } else {
+                RAYCHEL_ASSERT(new_type_id == details::TypeId<Translate<>>::id());
+                object_serializers_.at(i) =
+                    SerializableObjectData<SDFContainer>{details::SerializableObjectDescriptor<Translate<>>{}};
+            }
+        }
+
+        //Restore the ordering add_object() relies on. The sort is stable, so objects of the same type keep their order
+        std::vector<std::size_t> order(objects_.size());
+        std::iota(order.begin(), order.end(), std::size_t{});
+        std::stable_sort(order.begin(), order.end(), [this](std::size_t lhs, std::size_t rhs) {
+            return objects_.at(lhs).type_id() < objects_.at(rhs).type_id();
+        });
+
+        apply_order(objects_, order);
+        apply_order(object_serializers_, order);
+        apply_order(materials_, order);
+        apply_order(material_serializers_, order);
+    }
+
     void Scene::remove_object(std::size_t _index) noexcept
     {
         using Diff = std::iter_difference_t<decltype(objects_.begin())>;
@@ -0,0 +1,76 @@
+/**
+* \file SceneBuilder.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation file for SceneBuilder class
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/SceneBuilder.h"
+
+#include <iterator>
+
+namespace Raychel {
+
+    //Scene::add_object inserts every object in front of the others of its type, so each bucket is appended back to front
+    template <typename T>
+    static void append_reversed(std::vector<T>& destination, std::vector<T>& source) noexcept
+    {
+        destination.insert(destination.end(), std::make_move_iterator(source.rbegin()), std::make_move_iterator(source.rend()));
+    }
+
+    Scene SceneBuilder::build() noexcept
+    {
+        std::vector<SDFContainer> objects{};
+        std::vector<SerializableObjectData<SDFContainer>> object_serializers{};
+        std::vector<MaterialContainer> materials{};
+        std::vector<SerializableObjectData<MaterialContainer>> material_serializers{};
+
+        objects.reserve(object_count_);
+        object_serializers.reserve(object_count_);
+        materials.reserve(object_count_);
+        material_serializers.reserve(object_count_);
+
+        for (auto& [_, bucket] : buckets_) {
+            append_reversed(objects, bucket.objects);
+            append_reversed(object_serializers, bucket.object_serializers);
+            append_reversed(materials, bucket.materials);
+            append_reversed(material_serializers, bucket.material_serializers);
+        }
+
+        auto scene = Scene::unsafe_from_data(
+            std::move(objects), std::move(object_serializers), std::move(materials), std::move(material_serializers));
+        scene.compact_storage();
+        if (background_function_) {
+            scene.set_background_function(std::move(background_function_));
+        }
+
+        buckets_.clear();
+        last_bucket_ = nullptr;
+        object_count_ = 0U;
+        background_function_ = {};
+
+        return scene;
+    }
+
+} //namespace Raychel
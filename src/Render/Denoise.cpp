@@ -27,10 +27,25 @@
 */
 
 #include "Raychel/Render/Denoise.h"
+#include "Raychel/Core/CpuDispatch.h"
+#include "Raychel/Core/Xoroshiro128+.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
 #include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
 #include <thread>
+#include <tuple>
 
 namespace Raychel {
 
@@ -47,37 +62,6 @@ namespace Raychel {
         return a - b;
     }
 
-    template <std::size_t NumBins>
-    static double chi_squared_distance(const std::array<double, NumBins>& a, const std::array<double, NumBins>& b)
-    {
-        double sum{};
-        double num_nonempty_bins{};
-
-        for (std::size_t i{}; i != NumBins; ++i) {
-            const auto divisor = a[i] + b[i];
-            if (divisor != 0.0) {
-                sum += sq(a[i] - b[i]) / divisor;
-                ++num_nonempty_bins;
-            }
-        }
-
-        if (num_nonempty_bins == 0.0) {
-            return 0.0;
-        }
-
-        return sum / num_nonempty_bins;
-    }
-
-    template <std::size_t NumBins>
-    static auto chi_squared_distance(const RayHistogram<NumBins>& a, const RayHistogram<NumBins>& b)
-    {
-        //TODO: process the three channels in one loop
-        return Tuple{
-            chi_squared_distance(a.red_channel(), b.red_channel()),
-            chi_squared_distance(a.green_channel(), b.green_channel()),
-            chi_squared_distance(a.blue_channel(), b.blue_channel())};
-    }
-
     struct SearchWindow
     {
         [[nodiscard]] std::size_t width() const noexcept
@@ -100,101 +84,607 @@ namespace Raychel {
 
     using Patch = SearchWindow;
 
-    static SearchWindow
-    search_window_for_pixel(std::size_t x, std::size_t y, Size2D image_size, std::size_t half_search_window_size) noexcept
-    {
-        const auto start_x = safe_sub(x, half_search_window_size);
-        const auto start_y = safe_sub(y, half_search_window_size);
+    template <std::size_t NumChannels>
+    using ChannelSums = std::array<double, NumChannels>;
 
-        const auto end_x = std::min(x + half_search_window_size, image_size.x());
-        const auto end_y = std::min(y + half_search_window_size, image_size.y());
+    //Entry (x, y) of the table holds the sum over all pixels left of x and above y
+    template <std::size_t NumChannels>
+    static void build_summed_area_table(
+        std::vector<ChannelSums<NumChannels>>& table, const std::vector<ChannelSums<NumChannels>>& image, std::size_t width,
+        std::size_t height) noexcept
+    {
+        const auto table_width = width + 1U;
+        table.assign(table_width * (height + 1U), ChannelSums<NumChannels>{});
+
+        for (std::size_t y{}; y != height; ++y) {
+            ChannelSums<NumChannels> row_sum{};
+            for (std::size_t x{}; x != width; ++x) {
+                const auto& value = image[to_index(x, y, width)];
+                const auto& above = table[to_index(x + 1U, y, table_width)];
+                auto& entry = table[to_index(x + 1U, y + 1U, table_width)];
+                for (std::size_t i{}; i != NumChannels; ++i) {
+                    row_sum[i] += value[i];
+                    entry[i] = above[i] + row_sum[i];
+                }
+            }
+        }
+    }
 
-        return {start_x, start_y, end_x, end_y};
+    //Sum over all pixels of rect, which is given in the coordinates of the image the table was built from
+    template <std::size_t NumChannels>
+    static ChannelSums<NumChannels>
+    sum_over(const std::vector<ChannelSums<NumChannels>>& table, std::size_t width, const SearchWindow& rect) noexcept
+    {
+        const auto table_width = width + 1U;
+        const auto& top_left = table[to_index(rect.start_x, rect.start_y, table_width)];
+        const auto& top_right = table[to_index(rect.end_x, rect.start_y, table_width)];
+        const auto& bottom_left = table[to_index(rect.start_x, rect.end_y, table_width)];
+        const auto& bottom_right = table[to_index(rect.end_x, rect.end_y, table_width)];
+
+        ChannelSums<NumChannels> sum{};
+        for (std::size_t i{}; i != NumChannels; ++i) {
+            sum[i] = bottom_right[i] - top_right[i] - bottom_left[i] + top_left[i];
+        }
+        return sum;
     }
 
-    static Patch patch_for_pixel(std::size_t x, std::size_t y, Size2D image_size, std::size_t half_patch_size) noexcept
+    //Intersection of the square of side 2 * half_size + 1 around (x, y) with region, in the coordinates of region
+    static SearchWindow square_in_region(std::size_t x, std::size_t y, std::size_t half_size, const SearchWindow& region) noexcept
     {
-        return search_window_for_pixel(x, y, image_size, half_patch_size);
+        const auto start_x = std::max(safe_sub(x, half_size), region.start_x);
+        const auto start_y = std::max(safe_sub(y, half_size), region.start_y);
+        const auto end_x = std::min(x + half_size + 1U, region.end_x);
+        const auto end_y = std::min(y + half_size + 1U, region.end_y);
+
+        return {start_x - region.start_x, start_y - region.start_y, end_x - region.start_x, end_y - region.start_y};
     }
 
-    static std::vector<color> get_denoised_patch_with_search_window(
-        const SearchWindow& search_window, const Patch& this_patch, const std::vector<FatPixel>& input_pixels,
-        const Size2D image_size, const DenoisingOptions& options) noexcept
+    //Partner patch found by PatchMatch
+    struct PatchCandidate
+    {
+        std::ptrdiff_t offset_x{}, offset_y{};
+        //Per-channel sum of the chi squared distances over the patch, and the number of pixels in the sum
+        ChannelSums<4> distance_sum{};
+        //Mean chi squared distance over the patch and the channels. Candidates are ranked by it
+        double score{std::numeric_limits<double>::infinity()};
+    };
+
+    //Buffers of one denoising thread. They cover one tile and its halo, and are reused for all offsets and tiles
+    struct DenoisingScratch
+    {
+        //Per-channel chi squared distance of each pixel to its offset partner, and whether the partner exists
+        std::vector<ChannelSums<4>> distances{};
+        //Distances at a positive offset, over a region large enough to also give the distances at the negated offset
+        std::vector<ChannelSums<4>> shared_distances{};
+        std::vector<ChannelSums<4>> distance_table{};
+
+        //Whether the patch of each pixel matches the patch at the offset
+        std::vector<ChannelSums<3>> matches{};
+        std::vector<ChannelSums<3>> match_table{};
+
+        //The most similar patches found by PatchMatch, num_patch_matches per patch center, sorted by score
+        std::vector<PatchCandidate> patch_candidates{};
+
+        //Sum of the matching partner colors and number of matches for each pixel of the tile
+        std::vector<color> color_sums{};
+        std::vector<ChannelSums<3>> match_counts{};
+    };
+
+    //An earlier frame of an animation, moved to where the current frame sees the surfaces of its pixels
+    template <typename Pixel>
+    struct ReprojectedFrame
     {
-        std::vector<Tuple<double, 3>> c{this_patch.area()};
-        std::vector<color> V(this_patch.area());
+        std::vector<Pixel> pixels{};
+        //Whether each pixel could be reprojected
+        std::vector<std::uint8_t> valid{};
+    };
 
-        for (auto search_y = search_window.start_y; search_y != search_window.end_y; ++search_y) {
-            for (auto search_x = search_window.start_x; search_x != search_window.end_x; ++search_x) {
+    //Pixels that patches are compared with: the image itself, or an earlier frame reprojected onto it
+    template <typename Pixel>
+    struct PartnerImage
+    {
+        const std::vector<Pixel>& pixels;
+        //Whether each pixel exists. If null, all of them do
+        const std::vector<std::uint8_t>* valid{nullptr};
 
-                const auto& other_patch = patch_for_pixel(search_x, search_y, image_size, options.half_patch_size);
+        //Coordinates may be wrapped like offsets, so a single comparison catches negative ones as well
+        [[nodiscard]] bool has_pixel(std::size_t x, std::size_t y, Size2D image_size) const noexcept
+        {
+            if (x >= image_size.x() || y >= image_size.y()) {
+                return false;
+            }
+            return valid == nullptr || (*valid)[to_index(x, y, image_size.x())] != 0U;
+        }
+    };
 
-                for (auto this_y = this_patch.start_y; this_y != this_patch.end_y; ++this_y) {
-                    for (auto this_x = this_patch.start_x; this_x != this_patch.end_x; ++this_x) {
-                        const auto index_in_image = to_index(this_x, this_y, image_size.x());
-                        const auto& this_pixel = input_pixels.at(index_in_image);
-                        const auto index_in_patch =
-                            to_index(this_x - this_patch.start_x, this_y - this_patch.start_y, this_patch.width());
+    /**
+    * \brief Compute the chi squared distance between every pixel of region and the partner pixel at (offset_x, offset_y) from it
+    *
+    * Offsets are stored modulo 2^64, so x + offset_x wraps around for negative offsets and a single comparison with the
+    * image size tells if the partner pixel exists.
+    */
+    template <typename Pixel>
+    RAYCHEL_DISPATCH_KERNEL static void get_distance_image(
+        std::vector<ChannelSums<4>>& distances, const SearchWindow& region, std::size_t offset_x, std::size_t offset_y,
+        const std::vector<Pixel>& input_pixels, const PartnerImage<Pixel>& partner_image, Size2D image_size) noexcept
+    {
+        distances.resize(region.area());
 
-                        for (auto other_y = other_patch.start_y; other_y != other_patch.end_y; ++other_y) {
-                            for (auto other_x = other_patch.start_x; other_x != other_patch.end_x; ++other_x) {
+        for (auto y = region.start_y; y != region.end_y; ++y) {
+            const auto partner_y = y + offset_y;
+            for (auto x = region.start_x; x != region.end_x; ++x) {
+                const auto partner_x = x + offset_x;
+                auto& distance = distances[to_index(x - region.start_x, y - region.start_y, region.width())];
 
-                                const auto& other_pixel = input_pixels.at(to_index(other_x, other_y, image_size.x()));
-                                const auto d = chi_squared_distance(this_pixel.histogram, other_pixel.histogram);
+                if (!partner_image.has_pixel(partner_x, partner_y, image_size)) {
+                    distance = {};
+                    continue;
+                }
 
-                                for (std::size_t i{}; i != 3U; ++i) {
-                                    if (d[i] < options.distance_threshold) {
-                                        V.at(index_in_patch)[i] += other_pixel.noisy_color[i];
-                                        ++c.at(index_in_patch)[i];
-                                    }
-                                }
-                            }
-                        }
-                    }
+                const auto d = chi_squared_distance(
+                    input_pixels[to_index(x, y, image_size.x())].histogram,
+                    partner_image.pixels[to_index(partner_x, partner_y, image_size.x())].histogram);
+                distance = {d[0], d[1], d[2], 1.0};
+            }
+        }
+    }
+
+    /**
+    * \brief Add the matches at one offset to the sums of the tile. scratch.distances must hold the distances at that offset
+    *
+    * The distances form an image, whose summed area table gives the patch distance of each pixel in constant time. A second
+    * table over the matches gives the number of matching patches that contain each pixel. Neither step depends on the patch
+    * size.
+    */
+    template <typename Pixel>
+    static void add_matches_at_offset(
+        DenoisingScratch& scratch, const SearchWindow& tile, const SearchWindow& centers, const SearchWindow& patch_pixels,
+        std::size_t wrapped_offset_x, std::size_t wrapped_offset_y, const PartnerImage<Pixel>& partner_image, Size2D image_size,
+        DenoisingOptions options) noexcept
+    {
+        const auto half_patch_size = options.half_patch_size;
+        auto& color_sums = scratch.color_sums;
+        auto& match_counts = scratch.match_counts;
+
+        build_summed_area_table(scratch.distance_table, scratch.distances, patch_pixels.width(), patch_pixels.height());
+
+        for (auto y = centers.start_y; y != centers.end_y; ++y) {
+            const auto partner_y = y + wrapped_offset_y;
+            for (auto x = centers.start_x; x != centers.end_x; ++x) {
+                const auto partner_x = x + wrapped_offset_x;
+                auto& match = scratch.matches[to_index(x - centers.start_x, y - centers.start_y, centers.width())];
+                if (!partner_image.has_pixel(partner_x, partner_y, image_size)) {
+                    match = {};
+                    continue;
+                }
+
+                //distance_sum[3] is the number of pixels in the patch that have a partner
+                const auto patch = square_in_region(x, y, half_patch_size, patch_pixels);
+                const auto distance_sum = sum_over(scratch.distance_table, patch_pixels.width(), patch);
+                for (std::size_t i{}; i != 3U; ++i) {
+                    match[i] = distance_sum[i] < (options.distance_threshold * distance_sum[3]) ? 1.0 : 0.0;
                 }
             }
         }
+        build_summed_area_table(scratch.match_table, scratch.matches, centers.width(), centers.height());
+
+        for (auto y = tile.start_y; y != tile.end_y; ++y) {
+            const auto partner_y = y + wrapped_offset_y;
+            for (auto x = tile.start_x; x != tile.end_x; ++x) {
+                const auto partner_x = x + wrapped_offset_x;
+                if (!partner_image.has_pixel(partner_x, partner_y, image_size)) {
+                    continue;
+                }
+
+                const auto num_matches =
+                    sum_over(scratch.match_table, centers.width(), square_in_region(x, y, half_patch_size, centers));
+                const auto& partner = partner_image.pixels[to_index(partner_x, partner_y, image_size.x())];
 
-        for (std::size_t i{}; i != V.size(); ++i) {
-            for (std::size_t j{}; j != 3U; ++j) {
-                if (c.at(i)[j] != 0) {
-                    V.at(i)[j] /= c.at(i)[j];
+                const auto index_in_tile = to_index(x - tile.start_x, y - tile.start_y, tile.width());
+                for (std::size_t i{}; i != 3U; ++i) {
+                    color_sums[index_in_tile][i] += num_matches[i] * partner.noisy_color[i];
+                    match_counts[index_in_tile][i] += num_matches[i];
                 }
             }
         }
-        return V;
     }
 
-    static void denoise_part(
-        std::vector<color>& output, Size2D begin, Size2D end, const std::vector<FatPixel>& input_pixels, Size2D image_size,
+    /**
+    * \brief Copy the distances over region out of the distances over shared_region, shifted by shift
+    *
+    * Entry p of the result is entry p + shift of the shared distances, or empty if p + shift is outside the image.
+    */
+    static void copy_shifted_distances(
+        std::vector<ChannelSums<4>>& distances, const SearchWindow& region, const std::vector<ChannelSums<4>>& shared_distances,
+        const SearchWindow& shared_region, std::size_t wrapped_shift_x, std::size_t wrapped_shift_y, Size2D image_size) noexcept
+    {
+        distances.resize(region.area());
+
+        for (auto y = region.start_y; y != region.end_y; ++y) {
+            const auto shared_y = y + wrapped_shift_y;
+            for (auto x = region.start_x; x != region.end_x; ++x) {
+                const auto shared_x = x + wrapped_shift_x;
+                auto& distance = distances[to_index(x - region.start_x, y - region.start_y, region.width())];
+                if (shared_x >= image_size.x() || shared_y >= image_size.y()) {
+                    distance = {};
+                    continue;
+                }
+
+                RAYCHEL_ASSERT(shared_x >= shared_region.start_x && shared_x < shared_region.end_x);
+                RAYCHEL_ASSERT(shared_y >= shared_region.start_y && shared_y < shared_region.end_y);
+                distance = shared_distances[to_index(
+                    shared_x - shared_region.start_x, shared_y - shared_region.start_y, shared_region.width())];
+            }
+        }
+    }
+
+    /**
+    * \brief Add the matches of all offsets in the search window to the sums of the tile
+    *
+    * The chi squared distance is symmetric, so the distance of pixel p at offset -o is the distance of pixel p - o at offset
+    * o. The distances of each offset o in one half of the search window are computed once, over the pixels of all patches
+    * and those pixels shifted by -o, and serve both o and -o. This halves the number of distance evaluations.
+    */
+    template <typename Pixel>
+    static void add_exhaustive_matches(
+        DenoisingScratch& scratch, const SearchWindow& tile, const SearchWindow& centers, const SearchWindow& patch_pixels,
+        const std::vector<Pixel>& input_pixels, Size2D image_size, DenoisingOptions options) noexcept
+    {
+        const auto half_search_window_size = static_cast<std::ptrdiff_t>(options.half_search_window_size);
+        const PartnerImage<Pixel> partner_image{input_pixels};
+
+        scratch.matches.resize(centers.area());
+
+        //Offsets with offset_y > 0, or offset_y == 0 and offset_x >= 0
+        for (std::ptrdiff_t offset_y{}; offset_y <= half_search_window_size; ++offset_y) {
+            for (auto offset_x = offset_y == 0 ? 0 : -half_search_window_size; offset_x <= half_search_window_size; ++offset_x) {
+                const auto wrapped_offset_x = static_cast<std::size_t>(offset_x);
+                const auto wrapped_offset_y = static_cast<std::size_t>(offset_y);
+                const auto wrapped_negated_x = static_cast<std::size_t>(-offset_x);
+                const auto wrapped_negated_y = static_cast<std::size_t>(-offset_y);
+
+                //The pixels of all patches, and their partners at the negated offset
+                const SearchWindow shared_region{
+                    offset_x > 0 ? safe_sub(patch_pixels.start_x, static_cast<std::size_t>(offset_x)) : patch_pixels.start_x,
+                    safe_sub(patch_pixels.start_y, static_cast<std::size_t>(offset_y)),
+                    offset_x < 0 ? std::min(patch_pixels.end_x + static_cast<std::size_t>(-offset_x), image_size.x())
+                                 : patch_pixels.end_x,
+                    patch_pixels.end_y};
+
+                get_distance_image(
+                    scratch.shared_distances,
+                    shared_region,
+                    wrapped_offset_x,
+                    wrapped_offset_y,
+                    input_pixels,
+                    partner_image,
+                    image_size);
+
+                copy_shifted_distances(
+                    scratch.distances, patch_pixels, scratch.shared_distances, shared_region, 0U, 0U, image_size);
+                add_matches_at_offset(
+                    scratch, tile, centers, patch_pixels, wrapped_offset_x, wrapped_offset_y, partner_image, image_size, options);
+
+                if (offset_x == 0 && offset_y == 0) {
+                    continue;
+                }
+
+                copy_shifted_distances(
+                    scratch.distances,
+                    patch_pixels,
+                    scratch.shared_distances,
+                    shared_region,
+                    wrapped_negated_x,
+                    wrapped_negated_y,
+                    image_size);
+                add_matches_at_offset(
+                    scratch, tile, centers, patch_pixels, wrapped_negated_x, wrapped_negated_y, partner_image, image_size, options);
+            }
+        }
+    }
+
+    /**
+    * \brief Add the matches with the patches of an earlier frame, reprojected onto this one, to the sums of the tile
+    *
+    * Works like add_exhaustive_matches() with the partners taken from the earlier frame. Reprojection already lines the frames
+    * up, so a small search window is enough.
+    */
+    template <typename Pixel>
+    static void add_temporal_matches(
+        DenoisingScratch& scratch, const SearchWindow& tile, const SearchWindow& centers, const SearchWindow& patch_pixels,
+        const std::vector<Pixel>& input_pixels, const ReprojectedFrame<Pixel>& frame, Size2D image_size,
         DenoisingOptions options) noexcept
     {
-        std::vector<double> N(input_pixels.size());
+        const auto half_window_size = static_cast<std::ptrdiff_t>(options.half_temporal_window_size);
+        const PartnerImage<Pixel> partner_image{frame.pixels, &frame.valid};
+
+        scratch.matches.resize(centers.area());
+
+        for (auto offset_y = -half_window_size; offset_y <= half_window_size; ++offset_y) {
+            for (auto offset_x = -half_window_size; offset_x <= half_window_size; ++offset_x) {
+                const auto wrapped_offset_x = static_cast<std::size_t>(offset_x);
+                const auto wrapped_offset_y = static_cast<std::size_t>(offset_y);
+
+                get_distance_image(
+                    scratch.distances, patch_pixels, wrapped_offset_x, wrapped_offset_y, input_pixels, partner_image, image_size);
+                add_matches_at_offset(
+                    scratch, tile, centers, patch_pixels, wrapped_offset_x, wrapped_offset_y, partner_image, image_size, options);
+            }
+        }
+    }
+
+    /**
+    * \brief Per-channel chi squared distance between the patches around (x, y) and (x, y) + offset
+    *
+    * Like the summed area tables of add_exhaustive_matches(), only pixels whose partner exists are summed. The result is
+    * empty if the patch is certain to score worse than max_score, which is checked after every row.
+    */
+    template <typename Pixel>
+    static ChannelSums<4> get_patch_distance(
+        std::size_t x, std::size_t y, std::size_t offset_x, std::size_t offset_y, double max_score,
+        const std::vector<Pixel>& input_pixels, Size2D image_size, std::size_t half_patch_size) noexcept
+    {
+        const auto patch = square_in_region(x, y, half_patch_size, SearchWindow{0U, 0U, image_size.x(), image_size.y()});
+        //The score is the sum over all channels divided by at most this
+        const auto max_divisor = 3.0 * static_cast<double>(patch.area());
+
+        ChannelSums<4> distance_sum{};
+        for (auto patch_y = patch.start_y; patch_y != patch.end_y; ++patch_y) {
+            const auto partner_y = patch_y + offset_y;
+            if (partner_y >= image_size.y()) {
+                continue;
+            }
+            for (auto patch_x = patch.start_x; patch_x != patch.end_x; ++patch_x) {
+                const auto partner_x = patch_x + offset_x;
+                if (partner_x >= image_size.x()) {
+                    continue;
+                }
+
+                const auto d = chi_squared_distance(
+                    input_pixels[to_index(patch_x, patch_y, image_size.x())].histogram,
+                    input_pixels[to_index(partner_x, partner_y, image_size.x())].histogram);
+                distance_sum = {distance_sum[0] + d[0], distance_sum[1] + d[1], distance_sum[2] + d[2], distance_sum[3] + 1.0};
+            }
+
+            if (distance_sum[0] + distance_sum[1] + distance_sum[2] >= max_score * max_divisor) {
+                return {};
+            }
+        }
+        return distance_sum;
+    }
+
+    /**
+    * \brief Find the most similar patches of every center with PatchMatch and add their matches to the sums of the tile
+    *
+    * Every center starts with its own patch and random offsets. Each pass then scans the centers, alternating between
+    * forward and backward order. A center tries the offsets of the neighbors scanned before it, because neighboring patches
+    * tend to be similar at the same offset, and random offsets in windows of halving size around its best offset other than
+    * (0, 0). Each try costs one patch distance, so the cost depends on the number of candidates, not on the size of the
+    * search window.
+    *
+    * The matches are then added like in add_exhaustive_matches(), for the kept candidates only.
+    */
+    template <typename Pixel>
+    static void add_patch_matches(
+        DenoisingScratch& scratch, const SearchWindow& tile, const SearchWindow& centers, const std::vector<Pixel>& input_pixels,
+        Size2D image_size, DenoisingOptions options) noexcept
+    {
+        const auto num_candidates = options.num_patch_matches;
+        const auto half_search_window_size = static_cast<std::ptrdiff_t>(options.half_search_window_size);
+
+        auto& candidates = scratch.patch_candidates;
+        candidates.assign(centers.area() * num_candidates, PatchCandidate{});
+        const auto candidates_of = [&](std::size_t x, std::size_t y) {
+            const auto center_index = to_index(x - centers.start_x, y - centers.start_y, centers.width());
+            return std::span{candidates}.subspan(center_index * num_candidates, num_candidates);
+        };
+
+        const auto try_offset = [&](std::size_t x, std::size_t y, std::ptrdiff_t offset_x, std::ptrdiff_t offset_y) {
+            if (std::abs(offset_x) > half_search_window_size || std::abs(offset_y) > half_search_window_size) {
+                return;
+            }
+            const auto wrapped_offset_x = static_cast<std::size_t>(offset_x);
+            const auto wrapped_offset_y = static_cast<std::size_t>(offset_y);
+            if (x + wrapped_offset_x >= image_size.x() || y + wrapped_offset_y >= image_size.y()) {
+                return;
+            }
+
+            const auto list = candidates_of(x, y);
+            if (std::any_of(list.begin(), list.end(), [&](const PatchCandidate& candidate) {
+                    return candidate.offset_x == offset_x && candidate.offset_y == offset_y && std::isfinite(candidate.score);
+                })) {
+                return;
+            }
 
-        for (auto y = begin.y(); y != end.y(); ++y) {
-            for (auto x = begin.x(); x != end.x(); ++x) {
-                const auto this_patch = patch_for_pixel(x, y, image_size, options.half_patch_size);
-                const auto search_window = search_window_for_pixel(x, y, image_size, options.half_search_window_size);
+            auto& worst = list.back();
+            const auto distance_sum = get_patch_distance(
+                x, y, wrapped_offset_x, wrapped_offset_y, worst.score, input_pixels, image_size, options.half_patch_size);
+            if (distance_sum[3] == 0.0) {
+                return;
+            }
+
+            //The early exit of get_patch_distance() assumes a full patch, so patches at the border may still score worse
+            const auto score = (distance_sum[0] + distance_sum[1] + distance_sum[2]) / (3.0 * distance_sum[3]);
+            if (score >= worst.score) {
+                return;
+            }
 
-                const auto V =
-                    get_denoised_patch_with_search_window(search_window, this_patch, input_pixels, image_size, options);
+            worst = {offset_x, offset_y, distance_sum, score};
+            for (auto i = list.size() - 1U; i != 0U && list[i].score < list[i - 1U].score; --i) {
+                std::swap(list[i], list[i - 1U]);
+            }
+        };
 
-                for (auto patch_y = this_patch.start_y; patch_y != this_patch.end_y; ++patch_y) {
-                    for (auto patch_x = this_patch.start_x; patch_x != this_patch.end_x; ++patch_x) {
-                        const auto index_in_patch =
-                            to_index(patch_x - this_patch.start_x, patch_y - this_patch.start_y, this_patch.width());
-                        const auto index_in_image = to_index(patch_x, patch_y, image_size.x());
+        //Seeded by the tile, so the result does not depend on which thread denoises it or when
+        Xoroshiro128 rng{to_index(tile.start_x, tile.start_y, image_size.x()) + 1U};
+        std::uniform_int_distribution<std::ptrdiff_t> random_offset{-half_search_window_size, half_search_window_size};
 
-                        ++N.at(index_in_image);
+        for (auto y = centers.start_y; y != centers.end_y; ++y) {
+            for (auto x = centers.start_x; x != centers.end_x; ++x) {
+                try_offset(x, y, 0, 0);
+                for (std::size_t i{1U}; i < num_candidates; ++i) {
+                    try_offset(x, y, random_offset(rng), random_offset(rng));
+                }
+            }
+        }
 
-                        auto& p = output.at(index_in_image);
-                        p += (V.at(index_in_patch) - p) / N.at(index_in_image);
+        const auto try_neighbor = [&](std::size_t x, std::size_t y, std::size_t neighbor_x, std::size_t neighbor_y) {
+            if (neighbor_x < centers.start_x || neighbor_x >= centers.end_x || neighbor_y < centers.start_y ||
+                neighbor_y >= centers.end_y) {
+                return;
+            }
+            for (const auto& candidate : candidates_of(neighbor_x, neighbor_y)) {
+                if (std::isfinite(candidate.score)) {
+                    try_offset(x, y, candidate.offset_x, candidate.offset_y);
+                }
+            }
+        };
+
+        for (std::size_t pass{}; pass != options.patch_match_iterations; ++pass) {
+            const bool forward = pass % 2U == 0U;
+            for (std::size_t i{}; i != centers.area(); ++i) {
+                const auto index = forward ? i : centers.area() - 1U - i;
+                const auto x = centers.start_x + index % centers.width();
+                const auto y = centers.start_y + index / centers.width();
+
+                //Wrapped around for the backward pass
+                const auto step = forward ? std::size_t{1U} : static_cast<std::size_t>(-1);
+                try_neighbor(x, y, x - step, y);
+                try_neighbor(x, y, x, y - step);
+
+                for (auto radius = half_search_window_size; radius != 0; radius /= 2) {
+                    //The patch itself always scores 0, searching around it would never leave the center
+                    const auto list = candidates_of(x, y);
+                    const auto best = std::find_if(list.begin(), list.end(), [](const PatchCandidate& candidate) {
+                        return std::isfinite(candidate.score) && (candidate.offset_x != 0 || candidate.offset_y != 0);
+                    });
+                    if (best == list.end()) {
+                        break;
+                    }
+
+                    std::uniform_int_distribution<std::ptrdiff_t> random_step{-radius, radius};
+                    //try_offset() may reorder the candidates
+                    const auto best_x = best->offset_x;
+                    const auto best_y = best->offset_y;
+                    try_offset(x, y, best_x + random_step(rng), best_y + random_step(rng));
+                }
+            }
+        }
+
+        auto& color_sums = scratch.color_sums;
+        auto& match_counts = scratch.match_counts;
+        for (auto y = centers.start_y; y != centers.end_y; ++y) {
+            for (auto x = centers.start_x; x != centers.end_x; ++x) {
+                for (const auto& candidate : candidates_of(x, y)) {
+                    if (!std::isfinite(candidate.score)) {
+                        break;
+                    }
+
+                    const auto& distance_sum = candidate.distance_sum;
+                    ChannelSums<3> match{};
+                    for (std::size_t i{}; i != 3U; ++i) {
+                        match[i] = distance_sum[i] < (options.distance_threshold * distance_sum[3]) ? 1.0 : 0.0;
+                    }
+
+                    //Every pixel of the patch inside the tile receives the color of its partner
+                    const auto wrapped_offset_x = static_cast<std::size_t>(candidate.offset_x);
+                    const auto wrapped_offset_y = static_cast<std::size_t>(candidate.offset_y);
+                    const auto patch = square_in_region(x, y, options.half_patch_size, tile);
+                    for (auto patch_y = patch.start_y; patch_y != patch.end_y; ++patch_y) {
+                        const auto partner_y = patch_y + tile.start_y + wrapped_offset_y;
+                        for (auto patch_x = patch.start_x; patch_x != patch.end_x; ++patch_x) {
+                            const auto partner_x = patch_x + tile.start_x + wrapped_offset_x;
+                            if (partner_x >= image_size.x() || partner_y >= image_size.y()) {
+                                continue;
+                            }
+
+                            const auto& partner = input_pixels[to_index(partner_x, partner_y, image_size.x())];
+                            const auto index_in_tile = to_index(patch_x, patch_y, tile.width());
+                            for (std::size_t i{}; i != 3U; ++i) {
+                                color_sums[index_in_tile][i] += match[i] * partner.noisy_color[i];
+                                match_counts[index_in_tile][i] += match[i];
+                            }
+                        }
                     }
                 }
             }
         }
     }
 
+    /**
+    * \brief Denoise the pixels from begin to end
+    *
+    * Every pixel x is compared to the pixels x + o for the offsets o in the search window: all of them, or the most similar
+    * ones PatchMatch finds if options.num_patch_matches is set. Two pixels match if the mean chi squared distance over
+    * their patches is below the threshold. Each pixel q receives the colors of q + o from all patches containing q that
+    * matched at offset o. The same happens for the offsets in the temporal window of every reprojected earlier frame.
+    *
+    * All sums are accumulated in scratch, which only covers the tile and its halo. Only the pixels of the tile are written to
+    * output, so tiles can be denoised concurrently and in any order with the same result.
+    */
+    template <typename Pixel>
+    static void denoise_part(
+        std::vector<color>& output, DenoisingScratch& scratch, Size2D begin, Size2D end, const std::vector<Pixel>& input_pixels,
+        Size2D image_size, DenoisingOptions options, std::span<const ReprojectedFrame<Pixel>> previous_frames = {}) noexcept
+    {
+        const SearchWindow tile{begin.x(), begin.y(), end.x(), end.y()};
+        if (tile.area() == 0U) {
+            return;
+        }
+
+        const auto half_patch_size = options.half_patch_size;
+
+        //Centers of all patches that contain a pixel of the tile
+        const SearchWindow centers{
+            safe_sub(tile.start_x, half_patch_size),
+            safe_sub(tile.start_y, half_patch_size),
+            std::min(tile.end_x + half_patch_size, image_size.x()),
+            std::min(tile.end_y + half_patch_size, image_size.y())};
+        //Pixels of all patches around the centers
+        const SearchWindow patch_pixels{
+            safe_sub(centers.start_x, half_patch_size),
+            safe_sub(centers.start_y, half_patch_size),
+            std::min(centers.end_x + half_patch_size, image_size.x()),
+            std::min(centers.end_y + half_patch_size, image_size.y())};
+
+        scratch.color_sums.assign(tile.area(), color{});
+        scratch.match_counts.assign(tile.area(), ChannelSums<3>{});
+        auto& color_sums = scratch.color_sums;
+        auto& match_counts = scratch.match_counts;
+
+        if (options.num_patch_matches == 0U) {
+            add_exhaustive_matches(scratch, tile, centers, patch_pixels, input_pixels, image_size, options);
+        } else {
+            add_patch_matches(scratch, tile, centers, input_pixels, image_size, options);
+        }
+        for (const auto& frame : previous_frames) {
+            add_temporal_matches(scratch, tile, centers, patch_pixels, input_pixels, frame, image_size, options);
+        }
+
+        for (auto y = tile.start_y; y != tile.end_y; ++y) {
+            for (auto x = tile.start_x; x != tile.end_x; ++x) {
+                const auto index_in_tile = to_index(x - tile.start_x, y - tile.start_y, tile.width());
+                const auto index_in_image = to_index(x, y, image_size.x());
+
+                //Without a single match (only possible with a threshold <= 0), keep the noisy color
+                auto& p = output.at(index_in_image);
+                p = input_pixels[index_in_image].noisy_color;
+                for (std::size_t i{}; i != 3U; ++i) {
+                    if (match_counts[index_in_tile][i] != 0.0) {
+                        p[i] = color_sums[index_in_tile][i] / match_counts[index_in_tile][i];
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+    * \brief Subsample the image by a factor of 2^scale
+    *
+    * Pixel (x, y) of the result is the mean of the pixels from 2^scale * (x, y) up to (not including) 2^scale * (x + 1, y + 1).
+    * Every result pixel covers the same number of input pixels, so summed histograms all hold the same number of samples.
+    * Input pixels past the last whole block are dropped. The rows of the result are computed in parallel.
+    */
     template <
         typename Pixel, std::invocable<Pixel, Pixel> Add = std::plus<Pixel>,
         std::invocable<Pixel, std::size_t> Divide = std::divides<void>>
@@ -208,182 +698,467 @@ namespace Raychel {
             return input_pixels;
         }
 
-        const auto half_sample_window_size = (1U << (scale - 1));
-        const auto scaling_factor = std::pow(0.5, static_cast<double>(scale));
         const auto pixel_step = 1U << scale;
-        const auto scaled_size = input_pixels.size * scaling_factor;
+        const Size2D scaled_size{input_pixels.size.x() / pixel_step, input_pixels.size.y() / pixel_step};
 
-        if (scaled_size == Size2D{}) {
+        if (scaled_size.x() == 0U || scaled_size.y() == 0U) {
             return {};
         }
 
         std::vector<Pixel> output_pixels{scaled_size.x() * scaled_size.y(), Pixel{}};
 
-        for (std::size_t y{}; y != scaled_size.y(); ++y) {
+        std::vector<std::size_t> rows(scaled_size.y());
+        std::iota(rows.begin(), rows.end(), std::size_t{});
+
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::size_t y) {
             for (std::size_t x{}; x != scaled_size.x(); ++x) {
-                const auto sample_patch =
-                    patch_for_pixel(x * pixel_step, y * pixel_step, input_pixels.size, half_sample_window_size);
+                const Patch sample_patch{x * pixel_step, y * pixel_step, (x + 1U) * pixel_step, (y + 1U) * pixel_step};
 
-                std::size_t num_samples{};
                 Pixel output_pixel{};
-
                 for (auto patch_y = sample_patch.start_y; patch_y != sample_patch.end_y; ++patch_y) {
                     for (auto patch_x = sample_patch.start_x; patch_x != sample_patch.end_x; ++patch_x) {
-                        ++num_samples;
-                        const auto& sample_pixel = input_pixels.pixel_data.at(to_index(patch_x, patch_y, input_pixels.size.x()));
-
-                        output_pixel = adder(output_pixel, sample_pixel);
+                        output_pixel = adder(output_pixel, input_pixels.pixel_data[to_index(patch_x, patch_y, input_pixels.size.x())]);
                     }
                 }
-                output_pixel = divider(output_pixel, num_samples);
 
-                output_pixels.at(to_index(x, y, scaled_size.x())) = output_pixel;
+                output_pixels[to_index(x, y, scaled_size.x())] = divider(output_pixel, sample_patch.area());
             }
-        }
+        });
 
-        return {scaled_size, output_pixels};
+        return {scaled_size, std::move(output_pixels)};
     }
 
-    static void add_scaled_part(
-        const Raychel::Framebuffer& scaled_input, std::vector<Raychel::color>& output, std::size_t scale, std::size_t num_scales)
+    /**
+    * \brief Add the bilinear upsampling of coarse to fine, which has twice the size of coarse (rounded up)
+    *
+    * Pixel (x, y) of coarse is the mean of the pixels 2x and 2x + 1 in each direction of fine (see gaussian_subsample), so
+    * its center lies at (2x + 0.5, 2y + 0.5) in fine.
+    */
+    static void add_upsampled(std::vector<color>& fine, Size2D fine_size, const Framebuffer& coarse) noexcept
     {
-        using namespace Raychel;
-        RAYCHEL_ASSERT(scale < (sizeof(unsigned int) * 8));
-
-        if (scale == 0U) {
-            std::copy(scaled_input.pixel_data.begin(), scaled_input.pixel_data.end(), output.begin());
-            return;
-        }
-
-        const auto scaling_factor = 1U << scale;
-        const auto step_size = std::pow(0.5, static_cast<double>(scale));
-        const auto correction_factor = 0.5 / static_cast<double>(num_scales);
-
-        for (std::size_t y{}; y != scaled_input.size.y(); ++y) {
-            for (std::size_t x{}; x != scaled_input.size.x(); ++x) {
-                const auto next_x = std::min(x + 1U, scaled_input.size.x() - 1U);
-                const auto next_y = std::min(y + 1U, scaled_input.size.y() - 1U);
-
-                const auto top_left = scaled_input.at(x, y);
-                const auto top_right = scaled_input.at(next_x, y);
-                const auto bottom_left = scaled_input.at(x, next_y);
-                const auto bottom_right = scaled_input.at(next_x, next_y);
-
-                const auto large_x = x * scaling_factor;
-                const auto large_y = y * scaling_factor;
-
-                for (std::size_t part_y{}; part_y != scaling_factor; ++part_y) {
-                    for (std::size_t part_x{}; part_x != scaling_factor; ++part_x) {
-                        const auto relative_x = static_cast<double>(part_x) * step_size;
-                        const auto relative_y = static_cast<double>(part_y) * step_size;
-
-                        const auto right_weight = std::fmod(relative_x * static_cast<double>(scaling_factor), 1.0);
-                        const auto left_weight = 1.0 - right_weight;
-                        const auto bottom_weight = std::fmod(relative_y * static_cast<double>(scaling_factor), 1.0);
-                        const auto top_weight = 1.0 - bottom_weight;
-
-                        // clang-format off
-                    output.at(to_index(large_x + part_x, large_y + part_y, scaled_input.size.x() * scaling_factor)) += (
-                        (top_left * (top_weight * left_weight)) +
-                        (top_right * (top_weight * right_weight)) +
-                        (bottom_left * (top_weight * left_weight)) +
-                        (bottom_right * (bottom_weight * right_weight))
-                    ) * correction_factor;
-                        // clang-format on
-                    }
-                }
+        RAYCHEL_ASSERT(coarse.size.x() != 0U && coarse.size.y() != 0U);
+
+        const auto to_coarse = [](std::size_t fine_coordinate, std::size_t coarse_size) {
+            const auto coarse_coordinate =
+                std::clamp((static_cast<double>(fine_coordinate) - 0.5) / 2.0, 0.0, static_cast<double>(coarse_size - 1U));
+            const auto low = static_cast<std::size_t>(coarse_coordinate);
+            const auto high = std::min(low + 1U, coarse_size - 1U);
+            return std::tuple{low, high, coarse_coordinate - static_cast<double>(low)};
+        };
+
+        std::vector<std::size_t> rows(fine_size.y());
+        std::iota(rows.begin(), rows.end(), std::size_t{});
+
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::size_t y) {
+            const auto [top, bottom, bottom_weight] = to_coarse(y, coarse.size.y());
+            const auto top_weight = 1.0 - bottom_weight;
+
+            for (std::size_t x{}; x != fine_size.x(); ++x) {
+                const auto [left, right, right_weight] = to_coarse(x, coarse.size.x());
+                const auto left_weight = 1.0 - right_weight;
+
+                // clang-format off
+                fine[to_index(x, y, fine_size.x())] +=
+                    (coarse.at(left, top) * (top_weight * left_weight)) +
+                    (coarse.at(right, top) * (top_weight * right_weight)) +
+                    (coarse.at(left, bottom) * (bottom_weight * left_weight)) +
+                    (coarse.at(right, bottom) * (bottom_weight * right_weight));
+                // clang-format on
             }
-        }
+        });
     }
 
-    static void denoise_threaded(
-        std::vector<color>& output, const FatFramebuffer& input_pixels, unsigned int num_threads,
-        DenoisingOptions options) noexcept
+    //One image to denoise. Tiles of all jobs share one thread pool
+    template <typename Pixel>
+    struct DenoisingJob
     {
-        constexpr Size2D patch_size{128, 128};
+        const details::BasicFramebuffer<Pixel>* input;
+        std::vector<color>* output;
+        //Earlier frames of an animation, reprojected onto input
+        std::span<const ReprojectedFrame<Pixel>> previous_frames{};
+    };
 
-        std::vector<std::jthread> thread_pool{};
-        thread_pool.reserve(num_threads);
+    struct DenoisingTile
+    {
+        std::size_t job_index{};
+        Size2D begin{};
+        Size2D end{};
+    };
 
-        std::atomic_size_t current_patch_index{0U};
+    static constexpr Size2D denoising_tile_size{128, 128};
 
-        const auto num_patches_x =
-            static_cast<std::size_t>(std::ceil(static_cast<double>(input_pixels.size.x()) / static_cast<double>(patch_size.x())));
-        const auto num_patches_y =
-            static_cast<std::size_t>(std::ceil(static_cast<double>(input_pixels.size.y()) / static_cast<double>(patch_size.y())));
-        const auto max_patch_index = num_patches_x * num_patches_y - 1U;
+    template <typename Pixel>
+    static void denoise_threaded(const std::vector<DenoisingJob<Pixel>>& jobs, unsigned int num_threads, DenoisingOptions options) noexcept
+    {
+        constexpr auto tile_size = denoising_tile_size;
+
+        std::vector<DenoisingTile> tiles{};
+        for (std::size_t job_index{}; job_index != jobs.size(); ++job_index) {
+            const auto image_size = jobs[job_index].input->size;
+            for (std::size_t y{}; y < image_size.y(); y += tile_size.y()) {
+                for (std::size_t x{}; x < image_size.x(); x += tile_size.x()) {
+                    tiles.push_back(DenoisingTile{
+                        job_index,
+                        Size2D{x, y},
+                        Size2D{std::min(x + tile_size.x(), image_size.x()), std::min(y + tile_size.y(), image_size.y())}});
+                }
+            }
+        }
 
-        for (std::size_t i{}; i != num_threads; ++i) {
-            thread_pool.emplace_back([&, i] {
-                std::size_t patch_index{};
-                do {
-                    patch_index = current_patch_index.fetch_add(1U);
+        std::atomic_size_t next_tile_index{0U};
 
-                    const auto x_index = patch_index % num_patches_x;
-                    const auto y_index = patch_index / num_patches_x;
+        //More threads than tiles would only allocate scratch buffers that are never used
+        const auto num_used_threads = std::min(std::size_t{num_threads}, tiles.size());
 
-                    const Size2D patch_begin{
-                        std::min(x_index * patch_size.x(), input_pixels.size.x()),
-                        std::min(y_index * patch_size.y(), input_pixels.size.y())};
-                    const Size2D patch_end{
-                        std::min(patch_begin.x() + patch_size.x(), input_pixels.size.x()),
-                        std::min(patch_begin.y() + patch_size.y(), input_pixels.size.y())};
+        std::vector<std::jthread> thread_pool{};
+        thread_pool.reserve(num_used_threads);
+        for (std::size_t i{}; i != num_used_threads; ++i) {
+            thread_pool.emplace_back([&, i] {
+                DenoisingScratch scratch{};
+                for (auto tile_index = next_tile_index.fetch_add(1U); tile_index < tiles.size();
+                     tile_index = next_tile_index.fetch_add(1U)) {
+                    const auto& [job_index, begin, end] = tiles[tile_index];
+                    const auto& job = jobs[job_index];
 
-                    Logger::debug("Thread ", i, " got patch ", patch_index, " from ", patch_begin, " to ", patch_end, '\n');
+                    Logger::debug("Thread ", i, " got tile ", tile_index, " from ", begin, " to ", end, '\n');
 
-                    denoise_part(output, patch_begin, patch_end, input_pixels.pixel_data, input_pixels.size, options);
-                } while (patch_index < max_patch_index);
+                    denoise_part(
+                        *job.output, scratch, begin, end, job.input->pixel_data, job.input->size, options, job.previous_frames);
+                }
             });
         }
     }
 
-    void denoise_internal(std::vector<color>& output, const FatFramebuffer& input_pixels, DenoisingOptions options) noexcept
+    template <typename Pixel>
+    static void denoise_internal(const std::vector<DenoisingJob<Pixel>>& jobs, DenoisingOptions options) noexcept
     {
-        const auto num_threads = std::thread::hardware_concurrency();
+        //Always go through the tiles, so the scratch buffers never cover more than a tile and its halo
+        const auto num_threads = std::max(std::thread::hardware_concurrency(), 1U);
 
-        if (num_threads == 0U) {
-            denoise_part(output, Size2D{}, input_pixels.size, input_pixels.pixel_data, input_pixels.size, options);
-            return;
-        }
-
-        denoise_threaded(output, input_pixels, num_threads, options);
+        denoise_threaded(jobs, num_threads, options);
     }
 
-    Framebuffer denoise_single_scale(const FatFramebuffer& input_pixels, DenoisingOptions options) noexcept
+    template <typename Pixel>
+    Framebuffer denoise_single_scale(const details::BasicFramebuffer<Pixel>& input_pixels, DenoisingOptions options) noexcept
     {
         std::vector<color> output(input_pixels.pixel_data.size());
 
-        denoise_internal(output, input_pixels, options);
+        denoise_internal(std::vector{DenoisingJob<Pixel>{&input_pixels, &output}}, options);
 
         return {input_pixels.size, std::move(output)};
     }
 
-    Framebuffer denoise_multiscale(const FatFramebuffer& input_pixels, DenoisingOptions options) noexcept
+    /**
+    * \brief Move the pixels of an earlier frame to where the current frame sees the same surfaces
+    *
+    * Every pixel of the current frame is turned back into a world space point using the depth of its first hit and projected
+    * into the earlier frame. The earlier pixel is only used if it saw the same object at the same depth, so surfaces that were
+    * hidden in the earlier frame are left out. Pixels that hit the background only need to look in the same direction.
+    */
+    template <typename Pixel>
+    static ReprojectedFrame<Pixel>
+    reproject_frame(const AnimationFrame<Pixel>& frame, const AnimationFrame<Pixel>& current_frame, double max_depth_error) noexcept
     {
-        if (options.num_scales == 1U) {
+        const auto image_size = current_frame.pixels.size;
+        const auto& current_camera = current_frame.camera;
+        const auto& previous_camera = frame.camera;
+        const auto to_previous_camera = inverse(previous_camera.transform.rotation);
+
+        ReprojectedFrame<Pixel> result{
+            std::vector<Pixel>(frame.pixels.pixel_data.size(), Pixel{}), std::vector<std::uint8_t>(frame.pixels.pixel_data.size())};
+
+        std::vector<std::size_t> rows(image_size.y());
+        std::iota(rows.begin(), rows.end(), std::size_t{});
+
+        std::for_each(std::execution::par, rows.begin(), rows.end(), [&](std::size_t y) {
+            for (std::size_t x{}; x != image_size.x(); ++x) {
+                const auto& features = current_frame.features.pixel_data[to_index(x, y, image_size.x())];
+                const auto direction =
+                    get_primary_ray_direction(current_camera, image_size, x, y) * current_camera.transform.rotation;
+
+                //Directions to the background are the same from every position
+                const auto seen_from_previous =
+                    features.object_index == no_hit
+                        ? direction
+                        : current_camera.transform.offset + direction * features.depth - previous_camera.transform.offset;
+
+                const auto position = project_to_pixel(previous_camera, image_size, seen_from_previous * to_previous_camera);
+                if (!position.has_value()) {
+                    continue;
+                }
+
+                const auto previous_x = std::round(position->x());
+                const auto previous_y = std::round(position->y());
+                if (previous_x < 0.0 || previous_y < 0.0 || previous_x >= static_cast<double>(image_size.x()) ||
+                    previous_y >= static_cast<double>(image_size.y())) {
+                    continue;
+                }
+
+                const auto previous_index =
+                    to_index(static_cast<std::size_t>(previous_x), static_cast<std::size_t>(previous_y), image_size.x());
+                const auto& previous_features = frame.features.pixel_data[previous_index];
+                if (previous_features.object_index != features.object_index) {
+                    continue;
+                }
+                if (features.object_index != no_hit &&
+                    std::abs(previous_features.depth - mag(seen_from_previous)) > max_depth_error * previous_features.depth) {
+                    continue;
+                }
+
+                const auto index = to_index(x, y, image_size.x());
+                result.pixels[index] = frame.pixels.pixel_data[previous_index];
+                result.valid[index] = 1U;
+            }
+        });
+
+        return result;
+    }
+
+    template <typename Pixel>
+    Framebuffer denoise_temporal(
+        const AnimationFrame<Pixel>& current_frame, std::span<const AnimationFrame<Pixel>> previous_frames,
+        DenoisingOptions options) noexcept
+    {
+        const auto image_size = current_frame.pixels.size;
+        RAYCHEL_ASSERT(current_frame.features.size == image_size);
+
+        std::vector<ReprojectedFrame<Pixel>> reprojected_frames{};
+        reprojected_frames.reserve(previous_frames.size());
+        for (const auto& frame : previous_frames) {
+            RAYCHEL_ASSERT(frame.pixels.size == image_size && frame.features.size == image_size);
+            reprojected_frames.push_back(reproject_frame(frame, current_frame, options.max_reprojection_depth_error));
+
+            Logger::debug(
+                "Reprojected ",
+                std::count(reprojected_frames.back().valid.begin(), reprojected_frames.back().valid.end(), std::uint8_t{1U}),
+                " of ",
+                image_size.x() * image_size.y(),
+                " pixels\n");
+        }
+
+        std::vector<color> output(current_frame.pixels.pixel_data.size());
+
+        denoise_internal(
+            std::vector{DenoisingJob<Pixel>{
+                &current_frame.pixels, &output, std::span<const ReprojectedFrame<Pixel>>{reprojected_frames}}},
+            options);
+
+        return {image_size, std::move(output)};
+    }
+
+    /**
+    * Multiscale denoising after Delbracio et al., "Boosting Monte Carlo Rendering by Ray Histogram Fusion":
+    *
+    * 1. Build a pyramid by subsampling the input by 2 per level. The histograms are summed rather than averaged: chi
+    *    squared distances between histograms of the same distribution do not depend on the number of samples, while those
+    *    between different distributions grow with it. Averaged histograms would match everything at the coarse levels
+    * 2. Denoise all levels, concurrently
+    * 3. From the coarsest to the finest level, replace the low frequencies of each level by the level below it:
+    *    u_s += U(u_s+1 - D(u_s)), where D subsamples and U upsamples by 2
+    *
+    * Coarse levels remove low frequency noise that would need a huge search window at the finest level.
+    */
+    template <typename Pixel>
+    Framebuffer denoise_multiscale(const details::BasicFramebuffer<Pixel>& input_pixels, DenoisingOptions options) noexcept
+    {
+        if (options.num_scales <= 1U) {
             return denoise_single_scale(input_pixels, options);
         }
 
-        RAYCHEL_TODO("Multiscale denoising");
+        const auto average_color = [](Pixel pixel, std::size_t num_pixels) {
+            pixel.noisy_color = pixel.noisy_color / static_cast<double>(num_pixels);
+            return pixel;
+        };
+
+        std::vector<details::BasicFramebuffer<Pixel>> pyramid{};
+        pyramid.reserve(options.num_scales - 1U);
+        for (std::size_t scale{1U}; scale != options.num_scales; ++scale) {
+            const auto& finer = scale == 1U ? input_pixels : pyramid.back();
+            auto coarser = gaussian_subsample(finer, 1U, std::plus<Pixel>{}, average_color);
+            if (coarser.pixel_data.empty()) {
+                Logger::warn("Image is too small for ", options.num_scales, " scales, using ", scale, '\n');
+                break;
+            }
+            pyramid.push_back(std::move(coarser));
+        }
 
-        auto scale = options.num_scales - 1U;
+        std::vector<std::vector<color>> outputs{};
+        outputs.emplace_back(input_pixels.pixel_data.size());
+        for (const auto& level : pyramid) {
+            outputs.emplace_back(level.pixel_data.size());
+        }
 
-        std::vector<color> u_old{};
+        std::vector<DenoisingJob<Pixel>> jobs{DenoisingJob<Pixel>{&input_pixels, &outputs.front()}};
+        for (std::size_t i{}; i != pyramid.size(); ++i) {
+            jobs.push_back(DenoisingJob<Pixel>{&pyramid[i], &outputs[i + 1U]});
+        }
+        denoise_internal(jobs, options);
 
-        while (scale != 0) {
-            //uS = Ds(u)
-            const auto scaled_input = gaussian_subsample(input_pixels, scale);
-            //TODO: verify that the number of samples is still the same
+        for (auto level = pyramid.size(); level != 0U; --level) {
+            const auto fine_size = level == 1U ? input_pixels.size : pyramid[level - 2U].size;
+            const Framebuffer coarse{pyramid[level - 1U].size, std::move(outputs[level])};
 
-            std::vector<color> scaled_output{scaled_input.pixel_data.size(), color{}};
-            denoise_internal(scaled_output, scaled_input, options);
+            //The difference between the coarse estimate and the subsampled fine estimate
+            auto difference = gaussian_subsample(Framebuffer{fine_size, outputs[level - 1U]}, 1U);
+            for (std::size_t i{}; i != difference.pixel_data.size(); ++i) {
+                difference.pixel_data[i] = coarse.pixel_data[i] - difference.pixel_data[i];
+            }
+
+            add_upsampled(outputs[level - 1U], fine_size, difference);
+        }
 
-            add_scaled_part({input_pixels.size, scaled_output}, u_old, scale, options.num_scales);
+        return {input_pixels.size, std::move(outputs.front())};
+    }
+
+    /**
+    * \brief Hands out denoising tiles once the pixels they read have been rendered
+    *
+    * Render tiles and denoising tiles share one grid. A denoising tile reads the pixels up to halo pixels around it, so it
+    * waits for all render tiles overlapping that area.
+    */
+    class DenoisingSchedule
+    {
+        //Tile indices from first to last in each direction
+        struct TileRange
+        {
+            std::size_t first_x{}, first_y{}, last_x{}, last_y{};
+        };
 
-            --scale;
+    public:
+        DenoisingSchedule(Size2D image_size, std::size_t halo)
+        {
+            const auto tiles_x = (image_size.x() + denoising_tile_size.x() - 1U) / denoising_tile_size.x();
+            const auto tiles_y = (image_size.y() + denoising_tile_size.y() - 1U) / denoising_tile_size.y();
+
+            for (std::size_t y{}; y != tiles_y; ++y) {
+                for (std::size_t x{}; x != tiles_x; ++x) {
+                    const Size2D begin{x * denoising_tile_size.x(), y * denoising_tile_size.y()};
+                    const Size2D end{
+                        std::min(begin.x() + denoising_tile_size.x(), image_size.x()),
+                        std::min(begin.y() + denoising_tile_size.y(), image_size.y())};
+                    const TileRange dependencies{
+                        safe_sub(begin.x(), halo) / denoising_tile_size.x(),
+                        safe_sub(begin.y(), halo) / denoising_tile_size.y(),
+                        std::min(end.x() - 1U + halo, image_size.x() - 1U) / denoising_tile_size.x(),
+                        std::min(end.y() - 1U + halo, image_size.y() - 1U) / denoising_tile_size.y()};
+
+                    tiles_.push_back(DenoisingTile{0U, begin, end});
+                    dependencies_.push_back(dependencies);
+                    missing_render_tiles_.push_back(
+                        (dependencies.last_x - dependencies.first_x + 1U) * (dependencies.last_y - dependencies.first_y + 1U));
+                }
+            }
         }
 
-        return {input_pixels.size, std::move(u_old)};
+        void render_tile_done(Size2D begin) noexcept
+        {
+            const auto render_x = begin.x() / denoising_tile_size.x();
+            const auto render_y = begin.y() / denoising_tile_size.y();
+
+            {
+                std::scoped_lock lock{mutex_};
+                for (std::size_t i{}; i != tiles_.size(); ++i) {
+                    const auto& dependencies = dependencies_[i];
+                    if (render_x < dependencies.first_x || render_x > dependencies.last_x || render_y < dependencies.first_y ||
+                        render_y > dependencies.last_y) {
+                        continue;
+                    }
+                    if (--missing_render_tiles_[i] == 0U) {
+                        ready_tiles_.push_back(i);
+                    }
+                }
+            }
+            tile_ready_.notify_all();
+        }
+
+        //Wait for the next tile that can be denoised. Returns std::nullopt once all tiles have been handed out
+        [[nodiscard]] std::optional<DenoisingTile> next_tile() noexcept
+        {
+            std::unique_lock lock{mutex_};
+            tile_ready_.wait(lock, [this] { return !ready_tiles_.empty() || tiles_handed_out_ == tiles_.size(); });
+
+            if (ready_tiles_.empty()) {
+                return std::nullopt;
+            }
+
+            const auto tile_index = ready_tiles_.back();
+            ready_tiles_.pop_back();
+            ++tiles_handed_out_;
+            if (tiles_handed_out_ == tiles_.size()) {
+                tile_ready_.notify_all();
+            }
+            return tiles_[tile_index];
+        }
+
+    private:
+        std::vector<DenoisingTile> tiles_{};
+        std::vector<TileRange> dependencies_{};
+        std::vector<std::size_t> missing_render_tiles_{};
+
+        std::mutex mutex_{};
+        std::condition_variable tile_ready_{};
+        std::vector<std::size_t> ready_tiles_{};
+        std::size_t tiles_handed_out_{};
+    };
+
+    template <typename Pixel>
+    Framebuffer render_and_denoise(
+        const Scene& scene, const Camera& camera, const RenderOptions& render_options, DenoisingOptions options,
+        const DenoisedTileCallback& on_tile_denoised) noexcept
+    {
+        const auto image_size = render_options.output_size;
+        details::BasicFramebuffer<Pixel> input_pixels{image_size, std::vector<Pixel>(image_size.x() * image_size.y())};
+        Framebuffer output{image_size, std::vector<color>(input_pixels.pixel_data.size())};
+
+        //Pixels read by denoise_part around its tile: the patches of all patch centers, and their partners
+        const auto halo = 2U * options.half_patch_size + options.half_search_window_size;
+        DenoisingSchedule schedule{image_size, halo};
+
+        const auto num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+        {
+            std::vector<std::jthread> denoising_threads{};
+            denoising_threads.reserve(num_threads);
+            for (std::size_t i{}; i != num_threads; ++i) {
+                denoising_threads.emplace_back([&] {
+                    DenoisingScratch scratch{};
+                    while (const auto tile = schedule.next_tile()) {
+                        denoise_part(
+                            output.pixel_data, scratch, tile->begin, tile->end, input_pixels.pixel_data, image_size, options);
+                        if (on_tile_denoised) {
+                            on_tile_denoised(tile->begin, tile->end, output);
+                        }
+                    }
+                });
+            }
+
+            render_scene(input_pixels, scene, camera, render_options, denoising_tile_size, [&](Size2D begin, Size2D /*end*/) {
+                schedule.render_tile_done(begin);
+            });
+        }
+
+        return output;
     }
 
+    template Framebuffer denoise_single_scale(const FatFramebuffer&, DenoisingOptions) noexcept;
+    template Framebuffer denoise_single_scale(const FloatFatFramebuffer&, DenoisingOptions) noexcept;
+    template Framebuffer denoise_single_scale(const CompactFatFramebuffer&, DenoisingOptions) noexcept;
+
+    template Framebuffer denoise_multiscale(const FatFramebuffer&, DenoisingOptions) noexcept;
+    template Framebuffer denoise_multiscale(const FloatFatFramebuffer&, DenoisingOptions) noexcept;
+    template Framebuffer denoise_multiscale(const CompactFatFramebuffer&, DenoisingOptions) noexcept;
+
+    template Framebuffer
+    denoise_temporal(const AnimationFrame<FatPixel>&, std::span<const AnimationFrame<FatPixel>>, DenoisingOptions) noexcept;
+    template Framebuffer denoise_temporal(
+        const AnimationFrame<FloatFatPixel>&, std::span<const AnimationFrame<FloatFatPixel>>, DenoisingOptions) noexcept;
+    template Framebuffer denoise_temporal(
+        const AnimationFrame<CompactFatPixel>&, std::span<const AnimationFrame<CompactFatPixel>>, DenoisingOptions) noexcept;
+
+    template Framebuffer render_and_denoise<FatPixel>(
+        const Scene&, const Camera&, const RenderOptions&, DenoisingOptions, const DenoisedTileCallback&) noexcept;
+    template Framebuffer render_and_denoise<FloatFatPixel>(
+        const Scene&, const Camera&, const RenderOptions&, DenoisingOptions, const DenoisedTileCallback&) noexcept;
+    template Framebuffer render_and_denoise<CompactFatPixel>(
+        const Scene&, const Camera&, const RenderOptions&, DenoisingOptions, const DenoisedTileCallback&) noexcept;
+
 } // namespace Raychel
@@ -0,0 +1,336 @@
+/**
+* \file FeatureDenoise.cpp
+* \author Weckyy702 (weckyy702@gmail.com)
+* \brief Implementation of the edge-avoiding A-Trous wavelet filter by Holger Dammertz et al.
+* \date 2026-10-18
+*
+* MIT License
+* Copyright (c) [2022] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#include "Raychel/Core/CpuDispatch.h"
+#include "Raychel/Render/Denoise.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+namespace Raychel {
+
+    //Number of rows filtered by one task
+    static constexpr std::size_t rows_per_strip{16U};
+
+    //Weights of the B3 spline. The weight of a tap of the 5x5 footprint is the product of the weights of its row and column
+    static constexpr std::array<float, 5> spline_weights{1.F / 16.F, 1.F / 4.F, 3.F / 8.F, 1.F / 4.F, 1.F / 16.F};
+
+    //Structure of arrays copy of the features, so the filter loops over contiguous rows
+    struct GuidePlanes
+    {
+        std::vector<float> normal_x, normal_y, normal_z;
+        std::vector<float> depth;
+        std::vector<float> albedo_r, albedo_g, albedo_b;
+        //Variance of the noisy color, if the pixels know it
+        std::vector<float> color_variance;
+        std::vector<std::uint32_t> object_index;
+    };
+
+    struct ColorPlanes
+    {
+        std::vector<float> r, g, b;
+    };
+
+    //Weighted sums of one output row
+    struct RowSums
+    {
+        std::vector<float> r, g, b, weight;
+    };
+
+    struct AtrousPass
+    {
+        std::size_t step;
+        float color_sigma_sq;
+        float normal_scale;
+        float depth_sigma;
+        float albedo_scale;
+    };
+
+    /**
+    * \brief exp(-x) for x >= 0, with a relative error below 3e-4
+    *
+    * Computed as 2^-n * 2^-f with an integer n and a polynomial for 0 <= f < 1. Unlike std::exp, this vectorizes.
+    */
+    RAYCHEL_KERNEL_INLINE float negative_exp(float x) noexcept
+    {
+        //Past 2^-100 the weight does not matter anymore, and the exponent cannot underflow. Non-negative floats compare like
+        //their bits, and the integer minimum vectorizes without -ffinite-math-only
+        const auto t = std::bit_cast<float>(
+            std::min(std::bit_cast<std::int32_t>(x * 1.44269504F), std::bit_cast<std::int32_t>(100.F)));
+        const auto n = static_cast<std::int32_t>(t);
+        const auto f = t - static_cast<float>(n);
+
+        //Taylor series of exp(-f * ln(2))
+        const auto p =
+            1.F + f * (-0.69314718F + f * (0.24022651F + f * (-0.05550411F + f * (0.00961813F + f * -0.00133336F))));
+        return std::bit_cast<float>(std::bit_cast<std::int32_t>(p) - n * (1 << 23));
+    }
+
+    //A row of every plane, starting at the same pixel
+    struct PlaneRows
+    {
+        const float *normal_x, *normal_y, *normal_z;
+        const float* depth;
+        const float *albedo_r, *albedo_g, *albedo_b;
+        const std::uint32_t* object_index;
+        const float *r, *g, *b;
+    };
+
+    //Plain pointers, so the compiler does not have to reload them after every store to the row sums
+    RAYCHEL_KERNEL_INLINE PlaneRows get_rows(const GuidePlanes& guides, const ColorPlanes& colors, std::size_t first_pixel) noexcept
+    {
+        return {
+            guides.normal_x.data() + first_pixel,
+            guides.normal_y.data() + first_pixel,
+            guides.normal_z.data() + first_pixel,
+            guides.depth.data() + first_pixel,
+            guides.albedo_r.data() + first_pixel,
+            guides.albedo_g.data() + first_pixel,
+            guides.albedo_b.data() + first_pixel,
+            guides.object_index.data() + first_pixel,
+            colors.r.data() + first_pixel,
+            colors.g.data() + first_pixel,
+            colors.b.data() + first_pixel};
+    }
+
+    /**
+    * \brief Add count pixels of the tap rows q to the sums of the pixels of the center rows p
+    *
+    * The sums never overlap the planes. Without __restrict, checking that at runtime takes too many tests to vectorize.
+    */
+    RAYCHEL_KERNEL_INLINE void add_tap(
+        const PlaneRows& p, const PlaneRows& q, const float* color_variance, float* __restrict sum_r, float* __restrict sum_g,
+        float* __restrict sum_b, float* __restrict sum_weight, std::size_t count, float spline_weight, AtrousPass pass) noexcept
+    {
+        const auto spline_weight_bits = std::bit_cast<std::uint32_t>(spline_weight);
+
+        for (std::size_t x{}; x != count; ++x) {
+            const auto dr = p.r[x] - q.r[x];
+            const auto dg = p.g[x] - q.g[x];
+            const auto db = p.b[x] - q.b[x];
+            const auto color_distance = (dr * dr + dg * dg + db * db) / (pass.color_sigma_sq + color_variance[x]);
+
+            const auto dnx = p.normal_x[x] - q.normal_x[x];
+            const auto dny = p.normal_y[x] - q.normal_y[x];
+            const auto dnz = p.normal_z[x] - q.normal_z[x];
+            const auto normal_distance = (dnx * dnx + dny * dny + dnz * dnz) * pass.normal_scale;
+
+            const auto depth_distance = std::abs(p.depth[x] - q.depth[x]) / (pass.depth_sigma * p.depth[x] + FLT_MIN);
+
+            const auto dar = p.albedo_r[x] - q.albedo_r[x];
+            const auto dag = p.albedo_g[x] - q.albedo_g[x];
+            const auto dab = p.albedo_b[x] - q.albedo_b[x];
+            const auto albedo_distance = (dar * dar + dag * dag + dab * dab) * pass.albedo_scale;
+
+            //Masked instead of selected, which would stop the loop from being vectorized
+            const auto same_object_mask = std::uint32_t{0} - static_cast<std::uint32_t>(p.object_index[x] == q.object_index[x]);
+            const auto masked_weight = std::bit_cast<float>(spline_weight_bits & same_object_mask);
+            const auto weight =
+                masked_weight * negative_exp(color_distance + normal_distance + depth_distance + albedo_distance);
+
+            sum_r[x] += weight * q.r[x];
+            sum_g[x] += weight * q.g[x];
+            sum_b[x] += weight * q.b[x];
+            sum_weight[x] += weight;
+        }
+    }
+
+    RAYCHEL_DISPATCH_KERNEL static void filter_row(
+        const GuidePlanes& guides, const ColorPlanes& input, ColorPlanes& output, RowSums& sums, Size2D size, std::size_t y,
+        const AtrousPass& pass) noexcept
+    {
+        const auto [width, height] = size;
+        const auto p_row = y * width;
+
+        std::fill(sums.r.begin(), sums.r.end(), 0.F);
+        std::fill(sums.g.begin(), sums.g.end(), 0.F);
+        std::fill(sums.b.begin(), sums.b.end(), 0.F);
+        std::fill(sums.weight.begin(), sums.weight.end(), 0.F);
+
+        for (std::size_t tap_y{}; tap_y != spline_weights.size(); ++tap_y) {
+            const auto offset_y = static_cast<std::ptrdiff_t>(tap_y) - 2;
+            const auto q_y = static_cast<std::ptrdiff_t>(y) + offset_y * static_cast<std::ptrdiff_t>(pass.step);
+            if (q_y < 0 || q_y >= static_cast<std::ptrdiff_t>(height)) {
+                continue;
+            }
+
+            for (std::size_t tap_x{}; tap_x != spline_weights.size(); ++tap_x) {
+                const auto offset_x = (static_cast<std::ptrdiff_t>(tap_x) - 2) * static_cast<std::ptrdiff_t>(pass.step);
+                const auto distance_x = static_cast<std::size_t>(std::abs(offset_x));
+                if (distance_x >= width) {
+                    continue;
+                }
+
+                //Only the pixels whose tap is inside the image
+                const auto begin = offset_x < 0 ? distance_x : 0U;
+                const auto end = offset_x > 0 ? width - distance_x : width;
+                const auto q_first = static_cast<std::size_t>(
+                    q_y * static_cast<std::ptrdiff_t>(width) + static_cast<std::ptrdiff_t>(begin) + offset_x);
+
+                add_tap(
+                    get_rows(guides, input, p_row + begin),
+                    get_rows(guides, input, q_first),
+                    guides.color_variance.data() + p_row + begin,
+                    sums.r.data() + begin,
+                    sums.g.data() + begin,
+                    sums.b.data() + begin,
+                    sums.weight.data() + begin,
+                    end - begin,
+                    spline_weights[tap_x] * spline_weights[tap_y],
+                    pass);
+            }
+        }
+
+        //The center tap always has a positive weight
+        for (std::size_t x{}; x != width; ++x) {
+            output.r[p_row + x] = sums.r[x] / sums.weight[x];
+            output.g[p_row + x] = sums.g[x] / sums.weight[x];
+            output.b[p_row + x] = sums.b[x] / sums.weight[x];
+        }
+    }
+
+    template <typename Pixel>
+    static float get_color_variance(const Pixel& pixel) noexcept
+    {
+        if constexpr (requires { pixel.variance(); }) {
+            if (pixel.sample_count == 0U) {
+                return 0.F;
+            }
+            //Variance of the mean of the samples, averaged over the channels
+            const auto variance = pixel.variance();
+            return static_cast<float>((variance.r() + variance.g() + variance.b()) / (3.0 * pixel.sample_count));
+        }
+        return 0.F;
+    }
+
+    template <typename Pixel>
+    static std::pair<GuidePlanes, ColorPlanes>
+    split_planes(const details::BasicFramebuffer<Pixel>& input_pixels, const FeatureBuffer& features) noexcept
+    {
+        const auto pixel_count = input_pixels.pixel_data.size();
+
+        GuidePlanes guides{};
+        ColorPlanes colors{};
+        for (auto* plane :
+             {&guides.normal_x,
+              &guides.normal_y,
+              &guides.normal_z,
+              &guides.depth,
+              &guides.albedo_r,
+              &guides.albedo_g,
+              &guides.albedo_b,
+              &guides.color_variance,
+              &colors.r,
+              &colors.g,
+              &colors.b}) {
+            plane->resize(pixel_count);
+        }
+        guides.object_index.resize(pixel_count);
+
+        for (std::size_t i{}; i != pixel_count; ++i) {
+            const auto& pixel = input_pixels.pixel_data[i];
+            const auto& feature = features.pixel_data[i];
+
+            guides.normal_x[i] = static_cast<float>(feature.normal.x());
+            guides.normal_y[i] = static_cast<float>(feature.normal.y());
+            guides.normal_z[i] = static_cast<float>(feature.normal.z());
+            guides.depth[i] = static_cast<float>(feature.depth);
+            guides.albedo_r[i] = static_cast<float>(feature.albedo.r());
+            guides.albedo_g[i] = static_cast<float>(feature.albedo.g());
+            guides.albedo_b[i] = static_cast<float>(feature.albedo.b());
+            guides.color_variance[i] = get_color_variance(pixel);
+            //no_hit becomes the largest 32 bit index, which is still distinct from every object of a reasonable scene
+            guides.object_index[i] = static_cast<std::uint32_t>(std::min<std::size_t>(feature.object_index, UINT32_MAX));
+
+            colors.r[i] = static_cast<float>(pixel.noisy_color.r());
+            colors.g[i] = static_cast<float>(pixel.noisy_color.g());
+            colors.b[i] = static_cast<float>(pixel.noisy_color.b());
+        }
+
+        return {std::move(guides), std::move(colors)};
+    }
+
+    template <typename Pixel>
+    Framebuffer denoise_with_features(
+        const details::BasicFramebuffer<Pixel>& input_pixels, const FeatureBuffer& features, FeatureDenoisingOptions options) noexcept
+    {
+        RAYCHEL_ASSERT(input_pixels.size == features.size);
+
+        const auto size = input_pixels.size;
+        auto [guides, colors] = split_planes(input_pixels, features);
+        ColorPlanes filtered{colors};
+
+        const auto strip_count = (size.y() + rows_per_strip - 1U) / rows_per_strip;
+        std::vector<std::size_t> strips(strip_count);
+        std::iota(strips.begin(), strips.end(), std::size_t{});
+
+        for (std::size_t i{}; i != options.num_iterations; ++i) {
+            //The colors get smoother with every pass, so their differences matter more
+            const auto color_sigma = options.color_sigma / static_cast<double>(std::size_t{1} << i);
+            const AtrousPass pass{
+                .step = std::size_t{1} << i,
+                .color_sigma_sq = static_cast<float>(color_sigma * color_sigma),
+                .normal_scale = static_cast<float>(1.0 / options.normal_sigma),
+                .depth_sigma = static_cast<float>(options.depth_sigma),
+                .albedo_scale = static_cast<float>(1.0 / (options.albedo_sigma * options.albedo_sigma))};
+
+            std::for_each(std::execution::par, strips.begin(), strips.end(), [&](std::size_t strip) {
+                RowSums sums{};
+                for (auto* row : {&sums.r, &sums.g, &sums.b, &sums.weight}) {
+                    row->resize(size.x());
+                }
+
+                const auto first_row = strip * rows_per_strip;
+                for (auto y = first_row; y != std::min(first_row + rows_per_strip, size.y()); ++y) {
+                    filter_row(guides, colors, filtered, sums, size, y, pass);
+                }
+            });
+
+            std::swap(colors, filtered);
+        }
+
+        std::vector<color> output(input_pixels.pixel_data.size());
+        for (std::size_t i{}; i != output.size(); ++i) {
+            output[i] = color{colors.r[i], colors.g[i], colors.b[i]};
+        }
+        return {size, std::move(output)};
+    }
+
+    template Framebuffer denoise_with_features(const FatFramebuffer&, const FeatureBuffer&, FeatureDenoisingOptions) noexcept;
+    template Framebuffer denoise_with_features(const FloatFatFramebuffer&, const FeatureBuffer&, FeatureDenoisingOptions) noexcept;
+    template Framebuffer denoise_with_features(const CompactFatFramebuffer&, const FeatureBuffer&, FeatureDenoisingOptions) noexcept;
+    template Framebuffer denoise_with_features(const MomentFramebuffer&, const FeatureBuffer&, FeatureDenoisingOptions) noexcept;
+
+} // namespace Raychel
@@ -48,15 +48,23 @@ namespace Raychel {
             return get_background_color();
         }
 
-        const auto& [surfaces, materials, _, options] = data.state;
+        const auto& [surfaces, materials, frozen_surfaces, _, options] = data.state;
+        const auto& visible_surfaces = data.primary_surfaces != nullptr ? *data.primary_surfaces : frozen_surfaces;
         const auto result = raymarch(
-            data.origin, data.direction, surfaces, {options.max_ray_steps, options.max_ray_depth, options.surface_epsilon});
+            data.origin + data.direction * data.start_depth,
+            data.direction,
+            visible_surfaces,
+            {options.max_ray_steps,
+             options.max_ray_depth - data.start_depth,
+             options.surface_epsilon,
+             options.mixed_precision_marching});
 
         if (result.hit_index == no_hit) {
             return get_background_color();
         }
 
-        const auto surface_normal = get_normal(result.point, surfaces[result.hit_index], options.normal_epsilon);
+        const auto& surface = surfaces[result.hit_index];
+        const auto surface_normal = get_normal(result.point, surface, options.normal_epsilon);
         RAYCHEL_ASSERT(equivalent(mag_sq(surface_normal), 1.0));
 
         return data.state.materials[result.hit_index].get_surface_color(
@@ -64,7 +72,41 @@ namespace Raychel {
              .normal = surface_normal,
              .incoming_direction = data.direction,
              .state = data.state,
-             .recursion_depth = data.recursion_depth + 1U});
+             .recursion_depth = data.recursion_depth + 1U,
+             .material_index = surface.material_index(result.point)});
+    }
+
+    PixelFeatures get_pixel_features(const RenderData& data) noexcept
+    {
+        const auto& [surfaces, materials, frozen_surfaces, _, options] = data.state;
+        const auto& visible_surfaces = data.primary_surfaces != nullptr ? *data.primary_surfaces : frozen_surfaces;
+        const auto result = raymarch(
+            data.origin + data.direction * data.start_depth,
+            data.direction,
+            visible_surfaces,
+            {options.max_ray_steps,
+             options.max_ray_depth - data.start_depth,
+             options.surface_epsilon,
+             options.mixed_precision_marching});
+
+        if (result.hit_index == no_hit) {
+            return {};
+        }
+
+        const auto& surface = surfaces[result.hit_index];
+        const auto surface_normal = get_normal(result.point, surface, options.normal_epsilon);
+
+        return {
+            .normal = surface_normal,
+            .depth = mag(result.point - data.origin),
+            .albedo = materials[result.hit_index].get_material_albedo(
+                {.position = result.point + surface_normal * options.shading_epsilon,
+                 .normal = surface_normal,
+                 .incoming_direction = data.direction,
+                 .state = data.state,
+                 .recursion_depth = data.recursion_depth + 1U,
+                 .material_index = surface.material_index(result.point)}),
+            .object_index = result.hit_index};
     }
 
     static vec3 get_random_direction_on_weighted_hemisphere(const vec3& normal) noexcept
@@ -199,8 +241,8 @@ namespace Raychel {
         const auto result = raymarch(
             trace_origin,
             trace_direction,
-            data.state.surfaces,
-            {options.max_ray_steps, options.max_ray_depth, options.surface_epsilon});
+            data.state.frozen_surfaces,
+            {options.max_ray_steps, options.max_ray_depth, options.surface_epsilon, options.mixed_precision_marching});
 
         //        RAYCHEL_ASSERT(result.hit_index != no_hit)
         if (result.hit_index == no_hit) {
@@ -27,6 +27,9 @@
 */
 
 #include "Raychel/Render/Renderer.h"
+#include "Raychel/Core/FrozenScene.h"
+#include "Raychel/Core/Raymarch.h"
+#include "Raychel/Core/SDFLipschitz.h"
 #include "Raychel/Core/Scene.h"
 #include "Raychel/Core/ZigguratNormal.h"
 #include "Raychel/Render/FatPixel.h"
@@ -35,15 +38,22 @@
 #include "RaychelCore/ScopedTimer.h"
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <cmath>
 #include <execution>
 #include <fstream>
 #include <map>
+#include <numeric>
 #include <random>
+#include <span>
 #include <thread>
 
 namespace Raychel {
 
+    //Number of samples collected before they are added to a pixel
+    static constexpr std::size_t sample_batch_size{32U};
+
     struct CacheComparator
     {
         constexpr bool operator()(const auto& lhs, const auto& rhs) const
@@ -80,37 +90,11 @@ namespace Raychel {
 
     static void generate_rays_internal(std::vector<vec3>& rays, const Camera& camera, const RenderOptions options) noexcept
     {
-        using vec2 = basic_vec2<double>;
-        constexpr vec3 right{1, 0, 0};
-        constexpr vec3 up{0, 1, 0};
-        constexpr vec3 forward{0, 0, 1};
-
-        const auto get_relative_coordinates = [&options](const vec2 pixel_coordinate) {
-            const auto [plane_x, plane_y] = options.output_size;
-
-            const auto aspect_ratio = static_cast<double>(plane_x) / static_cast<double>(plane_y);
-
-            const auto raw_relative_x = pixel_coordinate.x() / static_cast<double>(plane_x) - 0.5;
-            const auto raw_relative_y = pixel_coordinate.y() / static_cast<double>(plane_y) - 0.5;
-            if (aspect_ratio > 1.0) {
-                return vec2{raw_relative_x * aspect_ratio, raw_relative_y};
-            }
-            return vec2{raw_relative_x, raw_relative_y / aspect_ratio};
-        };
-
         rays.reserve(options.output_size.y() * options.output_size.x());
 
-        for (std::size_t y{options.output_size.y()}; y != 0U; --y) {
+        for (std::size_t y{}; y != options.output_size.y(); ++y) {
             for (std::size_t x{}; x != options.output_size.x(); ++x) {
-                const auto [relative_x, relative_y] = get_relative_coordinates(vec2{x, y});
-
-                // clang-format off
-                const auto direction = normalize(   (right * relative_x) +
-                                                    (up * relative_y)    +
-                                                    (forward * camera.zoom));
-                // clang-format on
-
-                rays.emplace_back(direction);
+                rays.emplace_back(get_primary_ray_direction(camera, options.output_size, x, y));
             }
         }
     }
@@ -136,8 +120,173 @@ namespace Raychel {
         return normalize(direction + jitter);
     }
 
+    struct ViewCone
+    {
+        vec3 axis{};
+        double half_angle{};
+    };
+
+    //Smallest cone (roughly) around the camera position that contains every primary ray of the block
+    [[nodiscard]] static ViewCone get_block_cone(
+        const std::vector<vec3>& rays, const Camera& camera, const RenderOptions& options, std::size_t first_x,
+        std::size_t first_y, std::size_t block_size) noexcept
+    {
+        const auto [width, height] = options.output_size;
+        const auto last_x = std::min(first_x + block_size, width);
+        const auto last_y = std::min(first_y + block_size, height);
+
+        vec3 direction_sum{};
+        for (auto y = first_y; y != last_y; ++y) {
+            for (auto x = first_x; x != last_x; ++x) {
+                direction_sum += rays[y * width + x];
+            }
+        }
+        const auto axis = normalize(direction_sum);
+
+        double half_angle{};
+        for (auto y = first_y; y != last_y; ++y) {
+            for (auto x = first_x; x != last_x; ++x) {
+                half_angle = std::max(half_angle, std::acos(std::clamp(dot(axis, rays[y * width + x]), -1.0, 1.0)));
+            }
+        }
+
+        //Antialiasing moves each ray by at most one pixel in each direction, see get_direction_with_aa
+        if (options.do_aa) {
+            const auto max_jitter =
+                std::sqrt(sq(1.0 / static_cast<double>(width)) + sq(1.0 / static_cast<double>(height)));
+            half_angle += std::asin(std::min(max_jitter, 1.0));
+        }
+
+        //Leave some room for rounding errors
+        return {axis * camera.transform.rotation, half_angle + 1e-6};
+    }
+
+    [[nodiscard]] static bool may_be_visible(const AABB& bounds, const vec3& origin, const ViewCone& cone) noexcept
+    {
+        if (!bounds.is_finite()) {
+            return true;
+        }
+
+        const auto radius = mag(bounds.extent()) * 0.5;
+        const auto to_center = bounds.center() - origin;
+        const auto distance = mag(to_center);
+        if (distance <= radius) {
+            return true;
+        }
+
+        const auto angle_to_center = std::acos(std::clamp(dot(cone.axis, to_center / distance), -1.0, 1.0));
+        return angle_to_center <= cone.half_angle + std::asin(radius / distance);
+    }
+
+    /**
+    * \brief Build one FrozenScene per screen tile that only contains the objects that primary rays of that tile can hit
+    *
+    * The bounding sphere of every object is tested against a cone around all primary rays of the tile. The tile scenes do not
+    * get a DistanceGrid: primary rays are clipped against the bounds of the few objects of their tile, which already skips
+    * the empty space in front of them. The grid of the full scene would only bound the distance to all objects, which is
+    * smaller than the distance to the objects of the tile.
+    */
+    [[nodiscard]] static std::vector<FrozenScene> build_tile_scenes(
+        const Scene& scene, const FrozenScene& frozen_surfaces, const std::vector<vec3>& rays, const Camera& camera,
+        const RenderOptions& options) noexcept
+    {
+        const auto [width, height] = options.output_size;
+        const auto tile_size = options.culling_tile_size;
+        const auto tiles_per_row = (width + tile_size - 1U) / tile_size;
+        const auto tile_count = tiles_per_row * ((height + tile_size - 1U) / tile_size);
+
+        //Placeholders, every tile replaces its own
+        std::vector<FrozenScene> tile_scenes(tile_count, FrozenScene{scene.objects(), std::span<const std::size_t>{}});
+
+        std::vector<std::size_t> tile_indices(tile_count);
+        std::iota(tile_indices.begin(), tile_indices.end(), std::size_t{});
+
+        std::for_each(std::execution::par, tile_indices.begin(), tile_indices.end(), [&](std::size_t tile_index) {
+            const auto first_x = (tile_index % tiles_per_row) * tile_size;
+            const auto first_y = (tile_index / tiles_per_row) * tile_size;
+            const auto cone = get_block_cone(rays, camera, options, first_x, first_y, tile_size);
+
+            std::vector<std::size_t> visible_objects{};
+            const auto& object_bounds = frozen_surfaces.surface_bounds();
+            for (std::size_t i{}; i != object_bounds.size(); ++i) {
+                if (may_be_visible(object_bounds[i], camera.transform.offset, cone)) {
+                    visible_objects.emplace_back(i);
+                }
+            }
+
+            tile_scenes[tile_index] = FrozenScene{scene.objects(), visible_objects};
+        });
+
+        return tile_scenes;
+    }
+
+    /**
+    * \brief March a cone along its axis until it (almost) touches a surface
+    *
+    * Every ray inside the cone is free of surfaces up to the returned depth. A point of such a ray at depth s is at most
+    * (s - t) + t * chord away from the point on the axis at depth t, so the cone may advance by the scene distance minus
+    * t * chord.
+    */
+    [[nodiscard]] static double
+    march_cone(const ViewCone& cone, const vec3& origin, const FrozenScene& scene, double depth, const RenderOptions& options) noexcept
+    {
+        //Upper bound for the distance between two unit vectors inside the cone, relative to the depth
+        const auto chord = 2.0 * std::sin(cone.half_angle / 2.0);
+
+        for (std::size_t step{}; step != options.max_ray_steps && depth < options.max_ray_depth; ++step) {
+            const auto [distance, _] = evaluate_distance_field(scene, origin + cone.axis * depth);
+            const auto safe_step = distance - depth * chord;
+            if (safe_step < options.surface_epsilon) {
+                break;
+            }
+            depth += safe_step;
+        }
+        return std::min(depth, options.max_ray_depth);
+    }
+
+    /**
+    * \brief Depth up to which all primary rays of a pixel are known to be free of surfaces
+    *
+    * One cone is marched per 8x8 block of pixels. Each block is then split into 4x4 and 2x2 blocks, whose cones continue from
+    * the depth of their parent block.
+    */
+    [[nodiscard]] static std::vector<double> get_primary_start_depths(
+        const FrozenScene& scene, const std::vector<vec3>& rays, const Camera& camera, const RenderOptions& options) noexcept
+    {
+        const auto [width, height] = options.output_size;
+
+        //Depth of every pixel, refined level by level. All pixels of a block share the same depth
+        std::vector<double> start_depths(width * height);
+
+        for (const std::size_t block_size : {8U, 4U, 2U}) {
+            const auto blocks_per_row = (width + block_size - 1U) / block_size;
+            const auto block_count = blocks_per_row * ((height + block_size - 1U) / block_size);
+
+            std::vector<std::size_t> block_indices(block_count);
+            std::iota(block_indices.begin(), block_indices.end(), std::size_t{});
+
+            std::for_each(std::execution::par, block_indices.begin(), block_indices.end(), [&](std::size_t block_index) {
+                const auto first_x = (block_index % blocks_per_row) * block_size;
+                const auto first_y = (block_index / blocks_per_row) * block_size;
+
+                const auto cone = get_block_cone(rays, camera, options, first_x, first_y, block_size);
+                const auto depth =
+                    march_cone(cone, camera.transform.offset, scene, start_depths[first_y * width + first_x], options);
+
+                for (auto y = first_y; y != std::min(first_y + block_size, height); ++y) {
+                    for (auto x = first_x; x != std::min(first_x + block_size, width); ++x) {
+                        start_depths[y * width + x] = depth;
+                    }
+                }
+            });
+        }
+
+        return start_depths;
+    }
+
+    template <typename Pixel>
     [[maybe_unused]] static void
-    write_framebuffer(const std::string& file_name, Size2D size, const std::vector<FatPixel>& pixel_data) noexcept
+    write_framebuffer(const std::string& file_name, Size2D size, const std::vector<Pixel>& pixel_data) noexcept
     {
         std::ofstream output_image{file_name};
         if (!output_image) {
@@ -153,17 +302,75 @@ namespace Raychel {
         }
     }
 
-    [[nodiscard]] static std::vector<FatPixel>
-    render_fat_pixels(const Scene& scene, const Camera& camera, const RenderOptions& options) noexcept
+    //Counts the unfinished pixels of every tile and reports each tile once its last pixel is done
+    class TileCompletion
     {
+    public:
+        TileCompletion(Size2D image_size, Size2D tile_size, const RenderedTileCallback& on_tile_rendered)
+            : image_size_{image_size},
+              tile_size_{tile_size},
+              tiles_per_row_{(image_size.x() + tile_size.x() - 1U) / tile_size.x()},
+              remaining_pixels_(tiles_per_row_ * ((image_size.y() + tile_size.y() - 1U) / tile_size.y())),
+              on_tile_rendered_{on_tile_rendered}
+        {
+            for (std::size_t i{}; i != remaining_pixels_.size(); ++i) {
+                const auto [begin, end] = _tile_bounds(i);
+                remaining_pixels_[i].store((end.x() - begin.x()) * (end.y() - begin.y()), std::memory_order_relaxed);
+            }
+        }
+
+        //The pixel must be written before. The callback of the last pixel of a tile sees all pixels of that tile
+        void pixel_done(std::size_t pixel_index) const noexcept
+        {
+            const auto x = pixel_index % image_size_.x();
+            const auto y = pixel_index / image_size_.x();
+            const auto tile_index = (y / tile_size_.y()) * tiles_per_row_ + x / tile_size_.x();
+
+            if (remaining_pixels_[tile_index].fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+                const auto [begin, end] = _tile_bounds(tile_index);
+                on_tile_rendered_(begin, end);
+            }
+        }
+
+    private:
+        [[nodiscard]] std::pair<Size2D, Size2D> _tile_bounds(std::size_t tile_index) const noexcept
+        {
+            const Size2D begin{(tile_index % tiles_per_row_) * tile_size_.x(), (tile_index / tiles_per_row_) * tile_size_.y()};
+            const Size2D end{
+                std::min(begin.x() + tile_size_.x(), image_size_.x()), std::min(begin.y() + tile_size_.y(), image_size_.y())};
+            return {begin, end};
+        }
+
+        Size2D image_size_;
+        Size2D tile_size_;
+        std::size_t tiles_per_row_;
+        mutable std::vector<std::atomic_size_t> remaining_pixels_;
+        const RenderedTileCallback& on_tile_rendered_;
+    };
+
+    /**
+    * \brief Render one pixel per ray into pixels
+    *
+    * If tiles is set, it is told about every finished pixel. If features is set, it must hold one entry per ray, which
+    * receives the features of the center ray of that pixel.
+    */
+    template <typename Pixel>
+    static void render_pixels(
+        std::vector<Pixel>& pixels, const Scene& scene, const Camera& camera, const RenderOptions& options,
+        const TileCompletion* tiles, std::vector<PixelFeatures>* features = nullptr) noexcept
+    {
+        if (options.validate_lipschitz_constants) {
+            validate_lipschitz(scene.objects());
+        }
+
         const auto& rays = generate_rays(camera, options);
-        std::vector<FatPixel> fat_pixels{rays.size()};
+        RAYCHEL_ASSERT(pixels.size() == rays.size());
 
         ScopedTimer<std::chrono::milliseconds> timer{"Render time"};
 
         std::atomic_size_t pixels_rendered{};
 
-        std::jthread notifier{[&pixels_rendered, pixel_count = rays.size(), &fat_pixels, options] {
+        std::jthread notifier{[&pixels_rendered, pixel_count = rays.size(), &pixels, options] {
             using namespace std::chrono_literals;
 
             [[maybe_unused]] std::chrono::high_resolution_clock::time_point last_check_point{};
@@ -190,7 +397,7 @@ namespace Raychel {
                 const auto now = std::chrono::high_resolution_clock::now();
                 if (duration_cast<std::chrono::seconds>(now-last_check_point).count() >= 1) {
                     last_check_point = now;
-                    write_framebuffer("progress.ppm", options.output_size, fat_pixels);
+                    write_framebuffer("progress.ppm", options.output_size, pixels);
                 }
 #endif
                 std::this_thread::sleep_for(30ms);
@@ -198,9 +405,38 @@ namespace Raychel {
             Logger::log('\n');
         }};
 
-        const RenderState state{scene.objects(), scene.materials(), scene.background_function(), options};
+        const FrozenScene frozen_surfaces{scene.objects(), DistanceGridOptions{options.distance_grid_resolution}};
+        const RenderState state{scene.objects(), scene.materials(), frozen_surfaces, scene.background_function(), options};
+
+        std::vector<FrozenScene> tile_scenes{};
+        if (options.culling_tile_size != 0U) {
+            tile_scenes = build_tile_scenes(scene, frozen_surfaces, rays, camera, options);
+        }
+        std::vector<double> start_depths{};
+        if (options.cone_march_primary_rays) {
+            start_depths = get_primary_start_depths(frozen_surfaces, rays, camera, options);
+        }
+
+        const auto tiles_per_row = options.culling_tile_size == 0U
+                                       ? 0U
+                                       : (options.output_size.x() + options.culling_tile_size - 1U) / options.culling_tile_size;
+
+        //Parallel algorithms may pass copies of the elements, so the pixel index cannot be taken from the address of the ray
+        std::vector<std::size_t> pixel_indices(rays.size());
+        std::iota(pixel_indices.begin(), pixel_indices.end(), std::size_t{});
+
+        std::for_each(std::execution::par, pixel_indices.begin(), pixel_indices.end(), [&](std::size_t pixel_index) {
+            const auto& ray_direction = rays[pixel_index];
+            const auto start_depth = start_depths.empty() ? 0.0 : start_depths[pixel_index];
+
+            const FrozenScene* primary_surfaces{nullptr};
+            if (!tile_scenes.empty()) {
+                const auto x = pixel_index % options.output_size.x();
+                const auto y = pixel_index / options.output_size.x();
+                primary_surfaces =
+                    &tile_scenes[(y / options.culling_tile_size) * tiles_per_row + x / options.culling_tile_size];
+            }
 
-        std::transform(std::execution::par, rays.begin(), rays.end(), fat_pixels.begin(), [&](const vec3& ray_direction) {
             const auto get_direction = [&] {
                 if (options.do_aa) {
                     return get_direction_with_aa(ray_direction, options.output_size) * camera.transform.rotation;
@@ -208,27 +444,92 @@ namespace Raychel {
                 return ray_direction * camera.transform.rotation;
             };
 
-            FatPixel::Histogram histogram;
-            color pixel_color{};
+            //Samples are binned in batches, which is cheaper than binning them one by one
+            std::array<color, sample_batch_size> samples{};
+            std::size_t samples_in_batch{};
 
+            Pixel pixel{};
             for (std::size_t i{}; i != options.samples_per_pixel; ++i) {
                 const auto sample_direction = get_direction();
-                const auto sample = get_shaded_color(RenderData{camera.transform.offset, sample_direction, state, 0U});
-                histogram.add_sample(sample);
-                pixel_color += (sample / options.samples_per_pixel);
+                samples[samples_in_batch++] =
+                    get_shaded_color(RenderData{camera.transform.offset, sample_direction, state, 0U, primary_surfaces, start_depth});
+                if (samples_in_batch == sample_batch_size) {
+                    pixel.add_samples(samples, options.samples_per_pixel);
+                    samples_in_batch = 0U;
+                }
             }
+            pixel.add_samples(std::span{samples}.first(samples_in_batch), options.samples_per_pixel);
 
-            ++pixels_rendered;
+            pixels[pixel_index] = pixel;
+            if (features != nullptr) {
+                (*features)[pixel_index] = get_pixel_features(RenderData{
+                    camera.transform.offset, ray_direction * camera.transform.rotation, state, 0U, primary_surfaces, start_depth});
+            }
+            if (tiles != nullptr) {
+                tiles->pixel_done(pixel_index);
+            }
 
-            return FatPixel{pixel_color, histogram};
+            ++pixels_rendered;
         });
-
-        return fat_pixels;
     }
 
     FatFramebuffer render_scene(const Scene& scene, const Camera& camera, const RenderOptions& options) noexcept
     {
-        return {options.output_size, render_fat_pixels(scene, camera, options)};
+        return render_scene<FatPixel>(scene, camera, options);
+    }
+
+    template <typename Pixel>
+    details::BasicFramebuffer<Pixel> render_scene(const Scene& scene, const Camera& camera, const RenderOptions& options) noexcept
+    {
+        details::BasicFramebuffer<Pixel> output{options.output_size, std::vector<Pixel>(options.output_size.x() * options.output_size.y())};
+        render_pixels(output.pixel_data, scene, camera, options, nullptr);
+        return output;
+    }
+
+    template <typename Pixel>
+    std::pair<details::BasicFramebuffer<Pixel>, FeatureBuffer>
+    render_scene_with_features(const Scene& scene, const Camera& camera, const RenderOptions& options) noexcept
+    {
+        const auto pixel_count = options.output_size.x() * options.output_size.y();
+        details::BasicFramebuffer<Pixel> output{options.output_size, std::vector<Pixel>(pixel_count)};
+        FeatureBuffer features{options.output_size, std::vector<PixelFeatures>(pixel_count)};
+        render_pixels(output.pixel_data, scene, camera, options, nullptr, &features.pixel_data);
+        return {std::move(output), std::move(features)};
+    }
+
+    template <typename Pixel>
+    void render_scene(
+        details::BasicFramebuffer<Pixel>& output, const Scene& scene, const Camera& camera, const RenderOptions& options,
+        Size2D tile_size, const RenderedTileCallback& on_tile_rendered) noexcept
+    {
+        RAYCHEL_ASSERT(output.size == options.output_size);
+        RAYCHEL_ASSERT(tile_size.x() != 0U && tile_size.y() != 0U);
+
+        const TileCompletion tiles{options.output_size, tile_size, on_tile_rendered};
+        render_pixels(output.pixel_data, scene, camera, options, &tiles);
     }
 
+    template FatFramebuffer render_scene<FatPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+    template FloatFatFramebuffer render_scene<FloatFatPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+    template CompactFatFramebuffer render_scene<CompactFatPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+    template MomentFramebuffer render_scene<MomentPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+
+    template std::pair<FatFramebuffer, FeatureBuffer>
+    render_scene_with_features<FatPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+    template std::pair<FloatFatFramebuffer, FeatureBuffer>
+    render_scene_with_features<FloatFatPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+    template std::pair<CompactFatFramebuffer, FeatureBuffer>
+    render_scene_with_features<CompactFatPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+    template std::pair<MomentFramebuffer, FeatureBuffer>
+    render_scene_with_features<MomentPixel>(const Scene&, const Camera&, const RenderOptions&) noexcept;
+
+    template void render_scene(
+        FatFramebuffer&, const Scene&, const Camera&, const RenderOptions&, Size2D, const RenderedTileCallback&) noexcept;
+    template void render_scene(
+        FloatFatFramebuffer&, const Scene&, const Camera&, const RenderOptions&, Size2D, const RenderedTileCallback&) noexcept;
+    template void render_scene(
+        CompactFatFramebuffer&, const Scene&, const Camera&, const RenderOptions&, Size2D, const RenderedTileCallback&) noexcept;
+    template void render_scene(
+        MomentFramebuffer&, const Scene&, const Camera&, const RenderOptions&, Size2D, const RenderedTileCallback&) noexcept;
+
 } //namespace Raychel
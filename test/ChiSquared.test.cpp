@@ -0,0 +1,112 @@
+#include "Raychel/Render/FatPixel.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+    //The per-channel scalar implementation the vectorized kernel replaced
+    template <typename Channel>
+    double reference_chi_squared_distance(const Channel& a, double scale_a, const Channel& b, double scale_b)
+    {
+        double sum{};
+        double num_nonempty_bins{};
+
+        for (std::size_t i{}; i != a.size(); ++i) {
+            const auto a_i = static_cast<double>(a[i]) * scale_a;
+            const auto b_i = static_cast<double>(b[i]) * scale_b;
+            const auto divisor = a_i + b_i;
+            if (divisor != 0.0) {
+                sum += ((a_i - b_i) * (a_i - b_i)) / divisor;
+                ++num_nonempty_bins;
+            }
+        }
+
+        if (num_nonempty_bins == 0.0) {
+            return 0.0;
+        }
+
+        return sum / num_nonempty_bins;
+    }
+
+    template <typename Histogram>
+    std::array<double, 3> reference_chi_squared_distance(const Histogram& a, const Histogram& b)
+    {
+        return {
+            reference_chi_squared_distance(a.red_channel(), a.scale(), b.red_channel(), b.scale()),
+            reference_chi_squared_distance(a.green_channel(), a.scale(), b.green_channel(), b.scale()),
+            reference_chi_squared_distance(a.blue_channel(), a.scale(), b.blue_channel(), b.scale())};
+    }
+
+    template <typename Pixel>
+    std::vector<Pixel> make_pixels(std::size_t n_pixels, std::size_t samples_per_pixel)
+    {
+        std::mt19937 rng{1337};
+        std::exponential_distribution<double> dist{1.0};
+
+        std::vector<Pixel> pixels(n_pixels);
+        for (auto& pixel : pixels) {
+            for (std::size_t i{}; i != samples_per_pixel; ++i) {
+                pixel.add_sample(Raychel::color{dist(rng), dist(rng), dist(rng)}, samples_per_pixel);
+            }
+        }
+        return pixels;
+    }
+
+    template <typename Pixel>
+    void compare_implementations(const char* name)
+    {
+        constexpr std::size_t n_pixels{1'000};
+        constexpr std::size_t n_rounds{200};
+
+        const auto pixels = make_pixels<Pixel>(n_pixels, 16);
+
+        double max_difference{};
+        double reference_sink{};
+        double kernel_sink{};
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t round{}; round != n_rounds; ++round) {
+            for (std::size_t i{}; i != n_pixels; ++i) {
+                const auto d = reference_chi_squared_distance(pixels[i].histogram, pixels[(i + round + 1U) % n_pixels].histogram);
+                reference_sink += d[0] + d[1] + d[2];
+            }
+        }
+        const auto middle = std::chrono::steady_clock::now();
+        for (std::size_t round{}; round != n_rounds; ++round) {
+            for (std::size_t i{}; i != n_pixels; ++i) {
+                const auto d = chi_squared_distance(pixels[i].histogram, pixels[(i + round + 1U) % n_pixels].histogram);
+                kernel_sink += d[0] + d[1] + d[2];
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        for (std::size_t i{}; i != n_pixels; ++i) {
+            const auto& other = pixels[(i + 1U) % n_pixels].histogram;
+            const auto expected = reference_chi_squared_distance(pixels[i].histogram, other);
+            const auto actual = chi_squared_distance(pixels[i].histogram, other);
+            for (std::size_t channel{}; channel != 3U; ++channel) {
+                max_difference = std::max(max_difference, std::abs(expected[channel] - actual[channel]));
+            }
+        }
+
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        std::cout << name << ": reference " << Milliseconds{middle - start}.count() << "ms, kernel "
+                  << Milliseconds{end - middle}.count() << "ms, max difference " << max_difference << " (sums "
+                  << reference_sink << ", " << kernel_sink << ")\n";
+    }
+
+} // namespace
+
+int chi_squared_main()
+{
+    compare_implementations<Raychel::FatPixel>("double");
+    compare_implementations<Raychel::FloatFatPixel>("float");
+    compare_implementations<Raychel::CompactFatPixel>("uint16");
+
+    return 0;
+}
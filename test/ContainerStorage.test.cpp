@@ -0,0 +1,80 @@
+#include "Raychel/Core/SDFs.h"
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+    //Too large for the inline buffer of SDFContainer, so it always lands on the heap (or in the arena after compaction)
+    struct LargeSphere
+    {
+        Raychel::Sphere sphere;
+        std::array<double, 16> padding{};
+    };
+
+    double evaluate_sdf(const LargeSphere& s, const Raychel::vec3& p) noexcept
+    {
+        return evaluate_sdf(s.sphere, p);
+    }
+
+    template <typename Object>
+    std::vector<Raychel::SDFContainer> make_objects(std::size_t n_objects)
+    {
+        std::vector<Raychel::SDFContainer> objects{};
+        objects.reserve(n_objects);
+        for (std::size_t i{}; i != n_objects; ++i) {
+            objects.emplace_back(Object{Raychel::Sphere{1.0}});
+        }
+        return objects;
+    }
+
+    double evaluate_all(const std::vector<Raychel::SDFContainer>& objects, std::size_t n_points)
+    {
+        std::mt19937 rng{1337};
+        std::uniform_real_distribution<double> dist{-10.0, 10.0};
+
+        double sum{};
+        for (std::size_t i{}; i != n_points; ++i) {
+            const Raychel::vec3 p{dist(rng), dist(rng), dist(rng)};
+            for (const auto& object : objects) {
+                sum += object.evaluate(p);
+            }
+        }
+        return sum;
+    }
+
+    template <typename F>
+    double time_ms(F&& f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+int container_storage_main()
+{
+    constexpr std::size_t n_objects{10'000};
+    constexpr std::size_t n_points{1'000};
+
+    //The arena has to outlive the containers placed in it
+    Raychel::details::ContainerArena arena{};
+
+    const auto inline_objects = make_objects<Raychel::Sphere>(n_objects);
+    const auto heap_objects = make_objects<LargeSphere>(n_objects);
+    auto arena_objects = make_objects<LargeSphere>(n_objects);
+    for (auto& object : arena_objects) {
+        object.move_into(arena);
+    }
+
+    double sink{};
+    std::cout << "inline: " << time_ms([&] { sink += evaluate_all(inline_objects, n_points); }) << "ms\n";
+    std::cout << "heap:   " << time_ms([&] { sink += evaluate_all(heap_objects, n_points); }) << "ms\n";
+    std::cout << "arena:  " << time_ms([&] { sink += evaluate_all(arena_objects, n_points); }) << "ms\n";
+
+    return sink > 0.0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include "Raychel/Core/FrozenScene.h"
+#include "Raychel/Core/Raymarch.h"
+#include "Raychel/Core/SDFs.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+    //Every kind of surface the FrozenScene groups, plus some it has to evaluate through their SDFContainer
+    void add_objects(std::vector<Raychel::SDFContainer>& objects, std::size_t n_objects)
+    {
+        std::mt19937 rng{1337};
+        std::uniform_real_distribution<double> position{-5.0, 5.0};
+        std::uniform_real_distribution<double> size{0.2, 1.5};
+
+        for (std::size_t i{}; i != n_objects; ++i) {
+            const Raychel::vec3 center{position(rng), position(rng), position(rng)};
+            const Raychel::vec3 half_size{size(rng), size(rng), size(rng)};
+            const auto radius = size(rng);
+
+            //Identical neighbours tie everywhere and end up in different lanes of the grouped kernels
+            const auto copies = (i % 3U == 0U) ? 2U : 1U;
+            for (std::size_t copy{}; copy != copies; ++copy) {
+                switch (i % 7U) {
+                    case 0U:
+                        objects.emplace_back(Raychel::Sphere{radius});
+                        break;
+                    case 1U:
+                        objects.emplace_back(Raychel::Box{half_size});
+                        break;
+                    case 2U:
+                        objects.emplace_back(Raychel::Translate{Raychel::Sphere{radius}, center});
+                        break;
+                    case 3U:
+                        objects.emplace_back(Raychel::Translate{Raychel::Box{half_size}, center});
+                        break;
+                    case 4U:
+                        //What deserialized scenes contain
+                        objects.emplace_back(Raychel::Translate{Raychel::SDFContainer{Raychel::Sphere{radius}}, center});
+                        break;
+                    case 5U:
+                        objects.emplace_back(Raychel::Translate{Raychel::Plane{normalize(center)}, center});
+                        break;
+                    default:
+                        objects.emplace_back(Raychel::Translate{Raychel::Rounded{Raychel::Box{half_size}, 0.1}, center});
+                        break;
+                }
+            }
+        }
+    }
+
+} // namespace
+
+int frozen_scene_main()
+{
+    constexpr std::size_t n_points{100'000};
+
+    //The second pass repeats every object at a higher scene index and a different position in its group, so ties also
+    //occur between entries that share a lane
+    std::vector<Raychel::SDFContainer> objects{};
+    add_objects(objects, 100U);
+    add_objects(objects, 100U);
+    const Raychel::FrozenScene scene{objects};
+
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<double> coordinate{-8.0, 8.0};
+
+    std::size_t mismatched_distances{};
+    std::size_t mismatched_hits{};
+    for (std::size_t i{}; i != n_points; ++i) {
+        const Raychel::vec3 point{coordinate(rng), coordinate(rng), coordinate(rng)};
+
+        const auto [expected_distance, expected_hit] = evaluate_distance_field(objects, point);
+        const auto [actual_distance, actual_hit] = evaluate_distance_field(scene, point);
+
+        //The grouped kernels may contract the distance computation into FMAs, so only ask for the same result up to rounding
+        if (std::abs(expected_distance - actual_distance) > 1e-12 * std::max(1.0, expected_distance)) {
+            ++mismatched_distances;
+        }
+        //Ties always go to the first surface in the list
+        if (expected_hit != actual_hit) {
+            ++mismatched_hits;
+        }
+    }
+
+    std::cout << objects.size() << " surfaces (" << scene.spheres().size() << " grouped spheres, " << scene.boxes().size()
+              << " grouped boxes, " << scene.remaining_surfaces().size() << " others): " << mismatched_distances
+              << " different distances, " << mismatched_hits << " different hits\n";
+
+    return (mismatched_distances == 0U && mismatched_hits == 0U) ? 0 : 1;
+}
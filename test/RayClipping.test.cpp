@@ -0,0 +1,140 @@
+#include "Raychel/Core/FrozenScene.h"
+#include "Raychel/Core/Raymarch.h"
+#include "Raychel/Core/SDFs.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+    //Objects scattered in front of the origin, with lots of empty space between them
+    std::vector<Raychel::SDFContainer> make_objects(std::size_t n_objects)
+    {
+        std::mt19937 rng{1337};
+        std::uniform_real_distribution<double> position{-20.0, 20.0};
+        std::uniform_real_distribution<double> size{0.2, 1.0};
+
+        std::vector<Raychel::SDFContainer> objects{};
+        objects.reserve(n_objects);
+        for (std::size_t i{}; i != n_objects; ++i) {
+            const Raychel::vec3 center{position(rng), position(rng), position(rng) + 40.0};
+            if (i % 2U == 0U) {
+                objects.emplace_back(Raychel::Translate{Raychel::Sphere{size(rng)}, center});
+            } else {
+                const auto half_size = size(rng);
+                objects.emplace_back(Raychel::Translate{Raychel::Box{Raychel::vec3{half_size, half_size, half_size}}, center});
+            }
+        }
+        return objects;
+    }
+
+    std::vector<Raychel::vec3> make_directions(std::size_t n_rays)
+    {
+        std::mt19937 rng{42};
+        std::uniform_real_distribution<double> spread{-0.6, 0.6};
+
+        std::vector<Raychel::vec3> directions{};
+        directions.reserve(n_rays);
+        for (std::size_t i{}; i != n_rays; ++i) {
+            directions.emplace_back(normalize(Raychel::vec3{spread(rng), spread(rng), 1.0}));
+        }
+        return directions;
+    }
+
+    //The linear scan over all bounds that FrozenScene::clip_ray replaced
+    Raychel::RayInterval
+    reference_clip_ray(const Raychel::FrozenScene& scene, const Raychel::vec3& origin, const Raychel::vec3& direction)
+    {
+        auto result = Raychel::RayInterval::empty();
+        for (const auto& bounds : scene.surface_bounds()) {
+            const auto interval = intersect_ray(bounds, origin, direction);
+            if (interval.is_empty() || interval.exit < 0.0) {
+                continue;
+            }
+            result.entry = std::min(result.entry, interval.entry);
+            result.exit = std::max(result.exit, interval.exit);
+        }
+        return result;
+    }
+
+    template <typename F>
+    double time_ms(F&& f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+} // namespace
+
+int ray_clipping_main()
+{
+    constexpr std::size_t n_rays{100'000};
+    const Raychel::vec3 origin{};
+    const Raychel::RaymarchOptions options{.max_ray_steps = 1'024, .max_ray_depth = 500.0, .surface_epsilon = 1e-6};
+
+    const auto directions = make_directions(n_rays);
+
+    bool failed{false};
+
+    for (const std::size_t n_objects : {30U, 300U, 3'000U}) {
+        const auto objects = make_objects(n_objects);
+        const Raychel::FrozenScene scene{objects};
+
+        std::size_t mismatched_intervals{};
+        std::size_t mismatched_hits{};
+        std::size_t exhausted_rays{};
+        std::size_t unclipped_steps{};
+        std::size_t clipped_steps{};
+        for (const auto& direction : directions) {
+            const auto expected = reference_clip_ray(scene, origin, direction);
+            const auto actual = scene.clip_ray(origin, direction);
+            if (expected.is_empty() != actual.is_empty() ||
+                (!expected.is_empty() && (expected.entry != actual.entry || expected.exit != actual.exit))) {
+                ++mismatched_intervals;
+            }
+
+            //Marching the plain list of surfaces neither clips the ray nor uses any grouping
+            const auto unclipped = raymarch(origin, direction, objects, options);
+            const auto clipped = raymarch(origin, direction, scene, options);
+            unclipped_steps += unclipped.ray_steps;
+            clipped_steps += clipped.ray_steps;
+
+            //Rays that graze a surface can run out of steps before they reach it without clipping, so their hit is unknown
+            if (unclipped.ray_steps == options.max_ray_steps) {
+                ++exhausted_rays;
+            } else if (unclipped.hit_index != clipped.hit_index) {
+                ++mismatched_hits;
+            }
+        }
+
+        double sink{};
+        const auto add_to_sink = [&sink](const Raychel::RayInterval& interval) {
+            sink += interval.is_empty() ? 0.0 : interval.exit;
+        };
+        const auto reference_time = time_ms([&] {
+            for (const auto& direction : directions) {
+                add_to_sink(reference_clip_ray(scene, origin, direction));
+            }
+        });
+        const auto hierarchy_time = time_ms([&] {
+            for (const auto& direction : directions) {
+                add_to_sink(scene.clip_ray(origin, direction));
+            }
+        });
+
+        const auto steps_per_ray = [](std::size_t steps) {
+            return static_cast<double>(steps) / static_cast<double>(n_rays);
+        };
+        std::cout << n_objects << " objects: " << steps_per_ray(unclipped_steps) << " steps per ray unclipped, "
+                  << steps_per_ray(clipped_steps) << " clipped, " << mismatched_hits << " different hits (" << exhausted_rays
+                  << " rays ran out of steps), " << mismatched_intervals << " different intervals. clip_ray: linear "
+                  << reference_time << "ms, hierarchy " << hierarchy_time << "ms (sum " << sink << ")\n";
+
+        failed = failed || mismatched_intervals != 0U || mismatched_hits != 0U;
+    }
+
+    return failed ? 1 : 0;
+}
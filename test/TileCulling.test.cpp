@@ -0,0 +1,84 @@
+#include "Raychel/Core/SDFs.h"
+#include "Raychel/Core/Scene.h"
+#include "Raychel/Render/Renderer.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+
+    struct ConstantMaterial
+    {
+        Raychel::color surface_color{};
+    };
+
+    Raychel::color get_surface_color(const ConstantMaterial& material, const Raychel::ShadingData& /*unused*/) noexcept
+    {
+        return material.surface_color;
+    }
+
+    //Objects spread over the whole field of view, so every screen tile only sees a small part of them
+    Raychel::Scene make_scene(std::size_t n_objects)
+    {
+        std::mt19937 rng{1337};
+        std::uniform_real_distribution<double> position{-20.0, 20.0};
+        std::uniform_real_distribution<double> size{0.2, 1.0};
+
+        Raychel::Scene scene{};
+        for (std::size_t i{}; i != n_objects; ++i) {
+            const Raychel::vec3 center{position(rng), position(rng), position(rng) + 40.0};
+            const ConstantMaterial material{Raychel::color{size(rng)}};
+            if (i % 2U == 0U) {
+                scene.add_object(Raychel::Translate{Raychel::Sphere{size(rng)}, center}, material);
+            } else {
+                const auto half_size = size(rng);
+                const Raychel::Box box{Raychel::vec3{half_size, half_size, half_size}};
+                scene.add_object(Raychel::Translate{box, center}, material);
+            }
+        }
+        return scene;
+    }
+
+} // namespace
+
+int tile_culling_main()
+{
+    const auto scene = make_scene(400U);
+    const Raychel::Camera camera{};
+
+    Raychel::RenderOptions options{
+        .output_size = Raychel::Size2D{640, 360},
+        .max_recursion_depth = 0,
+        .max_lighting_bounces = 0,
+        .samples_per_pixel = 4,
+        .do_aa = false,
+    };
+
+    const auto render = [&](std::size_t culling_tile_size) {
+        options.culling_tile_size = culling_tile_size;
+        const auto start = std::chrono::steady_clock::now();
+        auto image = Raychel::render_scene(scene, camera, options);
+        std::cout << "tile size " << culling_tile_size << (options.cone_march_primary_rays ? " with" : " without")
+                  << " cone marching: "
+                  << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << "ms\n";
+        return image;
+    };
+
+    std::size_t different_pixels{};
+    for (const bool cone_march : {false, true}) {
+        options.cone_march_primary_rays = cone_march;
+        const auto unculled = render(0U);
+        const auto culled = render(32U);
+
+        //Culling must not change which objects the primary rays hit
+        for (std::size_t i{}; i != unculled.pixel_data.size(); ++i) {
+            if (unculled.pixel_data[i].noisy_color != culled.pixel_data[i].noisy_color) {
+                ++different_pixels;
+            }
+        }
+    }
+    std::cout << different_pixels << " pixels differ\n";
+
+    return different_pixels == 0U ? 0 : 1;
+}
@@ -92,6 +92,26 @@ double get_material_ior(const TransparentMaterial& material) noexcept
     return material.ior;
 }
 
+Raychel::color get_material_albedo(const FlatMaterial& material, const Raychel::ShadingData& /*unused*/) noexcept
+{
+    return material.surface_color;
+}
+
+Raychel::color get_material_albedo(const ReflectiveMaterial& material, const Raychel::ShadingData& /*unused*/) noexcept
+{
+    return material.reflectivity;
+}
+
+Raychel::color get_material_albedo(const DiffuseMaterial& material, const Raychel::ShadingData& /*unused*/) noexcept
+{
+    return material.surface_color;
+}
+
+Raychel::color get_material_albedo(const TransparentMaterial& material, const Raychel::ShadingData& /*unused*/) noexcept
+{
+    return material.transparency;
+}
+
 [[maybe_unused]] static void write_framebuffer(const std::string& file_name, const Raychel::Framebuffer& framebuffer) noexcept
 {
     //Don't bother writing an empty framebuffer
@@ -231,8 +251,9 @@ int main()
 
     auto scene = deserialize_scene(
         in_file,
-        object_deserializers<Translate<>, Rotate<>, Sphere, Box>(),
+        object_deserializers<Translate<>, Rotate<>, Scale<>, Transformed<>, Sphere, Box>(),
         material_deserializers<DiffuseMaterial, FlatMaterial, ReflectiveMaterial>());
+    scene.collapse_transforms();
 
 #endif
 